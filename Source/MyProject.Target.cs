@@ -11,5 +11,8 @@ public class MyProjectTarget : TargetRules
 		DefaultBuildSettings = BuildSettingsVersion.V4;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_3;
 		ExtraModuleNames.Add("MyProject");
+
+		//UHealthComponent replicates push based, see net.IsPushModelEnabled
+		bWithPushModel = true;
 	}
 }
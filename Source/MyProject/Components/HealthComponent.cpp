@@ -3,13 +3,21 @@
 
 #include "../Components/HealthComponent.h"
 
+#include "../Simulation/CombatSim.h"
+#include "../Subsystems/DamageableSpatialHashSubsystem.h"
+#include "../Telemetry/MatchTelemetrySubsystem.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/GameStateBase.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 
 UHealthComponent::UHealthComponent()
 {
 	DefaultHealth = 100;
 	Health = 100;
+	HealthServerTime = 0.0f;
+	SpatialHash = nullptr;
 	SetIsReplicated(true);
 }
 
@@ -22,10 +30,41 @@ void UHealthComponent::BeginPlay()
 		if(MyOwner)
 		{
 			MyOwner->OnTakeAnyDamage.AddDynamic(this, &UHealthComponent::HandleTakeAnyDamage);
+
+			SpatialHash = GetWorld()->GetSubsystem<UDamageableSpatialHashSubsystem>();
+			USceneComponent* OwnerRoot = MyOwner->GetRootComponent();
+			if(SpatialHash && OwnerRoot)
+			{
+				SpatialHash->Register(this, OwnerRoot->GetComponentLocation());
+				OwnerRoot->TransformUpdated.AddUObject(this, &UHealthComponent::HandleOwnerMoved);
+			}
 		}
 	}
 }
 
+void UHealthComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if(SpatialHash)
+	{
+		SpatialHash->Unregister(this);
+		SpatialHash = nullptr;
+		if(USceneComponent* OwnerRoot = GetOwner()->GetRootComponent())
+		{
+			OwnerRoot->TransformUpdated.RemoveAll(this);
+		}
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void UHealthComponent::HandleOwnerMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags,
+	ETeleportType Teleport)
+{
+	if(SpatialHash)
+	{
+		SpatialHash->UpdateLocation(this, UpdatedComponent->GetComponentLocation());
+	}
+}
+
 void UHealthComponent::HandleTakeAnyDamage(AActor* DamagedActor, float Damage, const UDamageType* DamageType,
 	AController* InstigatedBy, AActor* DamageCauser)
 {
@@ -33,13 +72,105 @@ void UHealthComponent::HandleTakeAnyDamage(AActor* DamagedActor, float Damage, c
 	{
 		return;
 	}
-	Health = FMath::Clamp(Health - Damage, 0.0f, DefaultHealth);
+	Health = FHealthSimState::ApplyDelta(Health, -Damage, DefaultHealth);
+	MarkHealthDirty();
+	UMatchTelemetrySubsystem::Record(this, ECombatTelemetryEvent::Damage, InstigatedBy ? InstigatedBy->GetPawn() : nullptr,
+		GetOwner(), DamageCauser, Damage);
 	OnHealthChanged.Broadcast(this, Health, Damage, DamageType,InstigatedBy, DamageCauser);
 }
 
+void UHealthComponent::MarkHealthDirty()
+{
+	HealthServerTime = GetWorld()->GetTimeSeconds();
+	MARK_PROPERTY_DIRTY_FROM_NAME(UHealthComponent, Health, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(UHealthComponent, HealthServerTime, this);
+}
+
+void UHealthComponent::SetHealth(float NewHealth)
+{
+	Health = FHealthSimState::ApplyDelta(NewHealth, 0.0f, DefaultHealth);
+	MarkHealthDirty();
+}
+
+float UHealthComponent::GetDisplayHealth() const
+{
+	if(GetOwnerRole() == ROLE_Authority || ActiveStatusEffects.Num() == 0)
+	{
+		return Health;
+	}
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	if(!GameState)
+	{
+		return Health;
+	}
+
+	const float ServerTime = GameState->GetServerWorldTimeSeconds();
+	float DisplayHealth = Health;
+	for(const FStatusEffectRecord& Record : ActiveStatusEffects)
+	{
+		//Only the part of the effect that ran after the last Health update
+		const float From = FMath::Max(Record.StartTime, HealthServerTime);
+		const float To = FMath::Min(Record.StartTime + Record.Duration, ServerTime);
+		if(To > From)
+		{
+			DisplayHealth += Record.HealthPerSecond * (To - From);
+		}
+	}
+	return FMath::Clamp(DisplayHealth, 0.0f, DefaultHealth);
+}
+
+void UHealthComponent::ApplyStatusEffectDelta(float Delta, const UDamageType* DamageType, AController* InstigatedBy,
+	AActor* DamageCauser)
+{
+	const float OldHealth = Health;
+	Health = FHealthSimState::ApplyDelta(Health, Delta, DefaultHealth);
+	if(Health == OldHealth)
+	{
+		return;
+	}
+	//Health and its timestamp always change together, so clients never add effect time the value already contains.
+	//With push model neither is sent here, clients interpolate ticking effects themselves and only a death goes out right away
+	HealthServerTime = GetWorld()->GetTimeSeconds();
+	if(IsDead())
+	{
+		MarkHealthDirty();
+	}
+	if(Health < OldHealth)
+	{
+		UMatchTelemetrySubsystem::Record(this, ECombatTelemetryEvent::Damage, InstigatedBy ? InstigatedBy->GetPawn() : nullptr,
+			GetOwner(), DamageCauser, OldHealth - Health);
+	}
+	OnHealthChanged.Broadcast(this, Health, OldHealth - Health, DamageType, InstigatedBy, DamageCauser);
+}
+
+void UHealthComponent::AddStatusEffectRecord(const FStatusEffectRecord& Record)
+{
+	//Resync the base value so the new effect is interpolated from a known point
+	MarkHealthDirty();
+	ActiveStatusEffects.Add(Record);
+	MARK_PROPERTY_DIRTY_FROM_NAME(UHealthComponent, ActiveStatusEffects, this);
+}
+
+void UHealthComponent::RemoveStatusEffectRecord(uint16 Handle)
+{
+	const int32 NumRemoved = ActiveStatusEffects.RemoveAllSwap([Handle](const FStatusEffectRecord& Record)
+	{
+		return Record.Handle == Handle;
+	});
+	if(NumRemoved > 0)
+	{
+		MarkHealthDirty();
+		MARK_PROPERTY_DIRTY_FROM_NAME(UHealthComponent, ActiveStatusEffects, this);
+	}
+}
+
 void UHealthComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-	
-	DOREPLIFETIME(UHealthComponent, Health);
-}
\ No newline at end of file
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(UHealthComponent, Health, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UHealthComponent, HealthServerTime, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UHealthComponent, ActiveStatusEffects, Params);
+}
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Components/SceneComponent.h"
+#include "StatusEffectTypes.h"
 #include "HealthComponent.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_SixParams(FOnHealthChangedSignature, class UHealthComponent*, HealthComp,float, Health, float, HealthDelta, const class UDamageType*, DamageType, class AController*, InstigatedBy, AActor*, DamageCauser);
@@ -19,24 +21,57 @@ public:
 
 protected:
 
+	//Push based, only sent on instant damage and status effect start/stop
 	UPROPERTY(Replicated, BlueprintReadOnly, Category= "HealthComponent")
 	float Health;
-	
+
+	//Server world time Health was last sent at, clients interpolate status effects from here
+	UPROPERTY(Replicated)
+	float HealthServerTime;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category= "HealthComponent")
 	float DefaultHealth;
 
+	UPROPERTY(Replicated)
+	TArray<FStatusEffectRecord> ActiveStatusEffects;
+
+	UPROPERTY(Transient)
+	class UDamageableSpatialHashSubsystem* SpatialHash;
+
 	UFUNCTION()
 	void HandleTakeAnyDamage(AActor* DamagedActor, float Damage, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser);
 
+	void MarkHealthDirty();
+
+	//Keeps the owner's cell in UDamageableSpatialHashSubsystem up to date
+	void HandleOwnerMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:
 
 	UFUNCTION(BlueprintCallable, Category= "HealthComponent")
 	float GetHealth() {return Health;}
 
+	//Health including locally interpolated status effects, use this for health bars
+	UFUNCTION(BlueprintCallable, Category= "HealthComponent")
+	float GetDisplayHealth() const;
+
+	bool IsDead() const {return Health <= 0.0f;}
+
+	//Server only, carries health over when a Mass combatant is promoted to this owner
+	void SetHealth(float NewHealth);
+
+	//Called by UStatusEffectSubsystem once per step with the summed delta of all effects on this owner
+	void ApplyStatusEffectDelta(float Delta, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser);
+
+	void AddStatusEffectRecord(const FStatusEffectRecord& Record);
+
+	void RemoveStatusEffectRecord(uint16 Handle);
+
 	UPROPERTY(BlueprintAssignable, Category = "Events")
 	FOnHealthChangedSignature OnHealthChanged;
 };
-
@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../Components/MyProjectCharacterMovementComponent.h"
+
+#include "EngineUtils.h"
+#include "GameFramework/Character.h"
+
+DECLARE_STATS_GROUP(TEXT("MyProjectMovement"), STATGROUP_MyProjectMovement, STATCAT_Advanced);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Server corrections"), STAT_MovementCorrections, STATGROUP_MyProjectMovement);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Server corrections while sprinting"), STAT_MovementSprintCorrections, STATGROUP_MyProjectMovement);
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice MovementCorrectionsCommand(
+	TEXT("mp.Movement.Corrections"),
+	TEXT("Print server movement corrections per character."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if(!World)
+		{
+			return;
+		}
+		for(TObjectIterator<UMyProjectCharacterMovementComponent> It; It; ++It)
+		{
+			if(It->GetWorld() != World || It->GetNumMovesChecked() == 0)
+			{
+				continue;
+			}
+			Ar.Logf(TEXT("%s: %d moves, %d corrections (%.2f%%), %d while sprinting"), *GetNameSafe(It->GetOwner()),
+				It->GetNumMovesChecked(), It->GetNumCorrections(), 100.0f * It->GetNumCorrections() / It->GetNumMovesChecked(),
+				It->GetNumSprintCorrections());
+		}
+	}));
+
+UMyProjectCharacterMovementComponent::UMyProjectCharacterMovementComponent()
+{
+	SprintSpeed = 700.0f;
+	AimWalkSpeed = 350.0f;
+	bWantsToSprint = false;
+	bWantsToAim = false;
+}
+
+float UMyProjectCharacterMovementComponent::GetMaxSpeed() const
+{
+	//Crouching caps the speed whatever else is held, MaxWalkSpeedCrouched comes from the base
+	if((MovementMode == MOVE_Walking || MovementMode == MOVE_NavWalking) && !IsCrouching())
+	{
+		if(bWantsToAim)
+		{
+			return AimWalkSpeed;
+		}
+		if(bWantsToSprint)
+		{
+			return SprintSpeed;
+		}
+	}
+	return Super::GetMaxSpeed();
+}
+
+void UMyProjectCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+	bWantsToSprint = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+	bWantsToAim = (Flags & FSavedMove_Character::FLAG_Custom_1) != 0;
+}
+
+bool UMyProjectCharacterMovementComponent::ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel,
+	const FVector& ClientLoc, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName,
+	uint8 ClientMovementMode)
+{
+	const bool bNeedsCorrection = Super::ServerCheckClientError(ClientTimeStamp, DeltaTime, Accel, ClientLoc, RelativeClientLocation,
+		ClientMovementBase, ClientBaseBoneName, ClientMovementMode);
+	++NumMovesChecked;
+	if(bNeedsCorrection)
+	{
+		++NumCorrections;
+		INC_DWORD_STAT(STAT_MovementCorrections);
+		if(bWantsToSprint)
+		{
+			++NumSprintCorrections;
+			INC_DWORD_STAT(STAT_MovementSprintCorrections);
+		}
+	}
+	return bNeedsCorrection;
+}
+
+FNetworkPredictionData_Client* UMyProjectCharacterMovementComponent::GetPredictionData_Client() const
+{
+	if(!ClientPredictionData)
+	{
+		UMyProjectCharacterMovementComponent* MutableThis = const_cast<UMyProjectCharacterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_MyProject(*this);
+	}
+	return ClientPredictionData;
+}
+
+void FSavedMove_MyProject::Clear()
+{
+	Super::Clear();
+	bSavedWantsToSprint = false;
+	bSavedWantsToAim = false;
+}
+
+uint8 FSavedMove_MyProject::GetCompressedFlags() const
+{
+	uint8 Result = Super::GetCompressedFlags();
+	if(bSavedWantsToSprint)
+	{
+		Result |= FLAG_Custom_0;
+	}
+	if(bSavedWantsToAim)
+	{
+		Result |= FLAG_Custom_1;
+	}
+	return Result;
+}
+
+bool FSavedMove_MyProject::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	const FSavedMove_MyProject* NewMyProjectMove = static_cast<const FSavedMove_MyProject*>(NewMove.Get());
+	if(bSavedWantsToSprint != NewMyProjectMove->bSavedWantsToSprint || bSavedWantsToAim != NewMyProjectMove->bSavedWantsToAim)
+	{
+		return false;
+	}
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_MyProject::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel,
+	FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+	if(const UMyProjectCharacterMovementComponent* MoveComp = Cast<UMyProjectCharacterMovementComponent>(C->GetCharacterMovement()))
+	{
+		bSavedWantsToSprint = MoveComp->bWantsToSprint;
+		bSavedWantsToAim = MoveComp->bWantsToAim;
+	}
+}
+
+void FSavedMove_MyProject::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+	//Replayed moves after a correction use the flags they were originally made with
+	if(UMyProjectCharacterMovementComponent* MoveComp = Cast<UMyProjectCharacterMovementComponent>(C->GetCharacterMovement()))
+	{
+		MoveComp->bWantsToSprint = bSavedWantsToSprint;
+		MoveComp->bWantsToAim = bSavedWantsToAim;
+	}
+}
+
+FNetworkPredictionData_Client_MyProject::FNetworkPredictionData_Client_MyProject(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_MyProject::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_MyProject());
+}
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "MyProjectCharacterMovementComponent.generated.h"
+
+/**
+ * Character movement with sprint and aim-down-sights carried in the saved moves, so the server simulates
+ * the same speeds as the predicting client and does not have to correct it.
+ */
+UCLASS()
+class MYPROJECT_API UMyProjectCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+	friend class FSavedMove_MyProject;
+
+public:
+	UMyProjectCharacterMovementComponent();
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Walking", meta = (ClampMin = "0", UIMin = "0", ForceUnits = "cm/s"))
+	float SprintSpeed;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Walking", meta = (ClampMin = "0", UIMin = "0", ForceUnits = "cm/s"))
+	float AimWalkSpeed;
+
+	void SetWantsToSprint(bool bNewWantsToSprint) {bWantsToSprint = bNewWantsToSprint;}
+
+	void SetWantsToAim(bool bNewWantsToAim) {bWantsToAim = bNewWantsToAim;}
+
+	bool IsSprinting() const {return bWantsToSprint && !bWantsToAim && !IsCrouching() && IsMovingOnGround();}
+
+	bool IsAiming() const {return bWantsToAim;}
+
+	//Server side counts of checked moves and corrections sent back, see mp.Movement.Corrections
+	int32 GetNumMovesChecked() const {return NumMovesChecked;}
+
+	int32 GetNumCorrections() const {return NumCorrections;}
+
+	int32 GetNumSprintCorrections() const {return NumSprintCorrections;}
+
+	virtual float GetMaxSpeed() const override;
+
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+protected:
+
+	virtual bool ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientLoc,
+		const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+
+private:
+
+	uint8 bWantsToSprint : 1;
+
+	uint8 bWantsToAim : 1;
+
+	int32 NumMovesChecked = 0;
+
+	int32 NumCorrections = 0;
+
+	int32 NumSprintCorrections = 0;
+};
+
+class FSavedMove_MyProject : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	virtual void Clear() override;
+
+	virtual uint8 GetCompressedFlags() const override;
+
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+
+	virtual void PrepMoveFor(ACharacter* C) override;
+
+	uint8 bSavedWantsToSprint : 1;
+
+	uint8 bSavedWantsToAim : 1;
+};
+
+class FNetworkPredictionData_Client_MyProject : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	explicit FNetworkPredictionData_Client_MyProject(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StatusEffectTypes.generated.h"
+
+class UDamageType;
+
+UENUM(BlueprintType)
+enum class EStatusEffectKind : uint8
+{
+	Burning,
+	Bleeding,
+	Regeneration
+};
+
+//Description of an effect to apply, usually filled in on a weapon or zone
+USTRUCT(BlueprintType)
+struct FStatusEffectSpec
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "StatusEffect")
+	EStatusEffectKind Kind = EStatusEffectKind::Burning;
+
+	/** Health change per second, negative values deal damage */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "StatusEffect")
+	float HealthPerSecond = -5.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "StatusEffect", meta = (ClampMin = 0.0))
+	float Duration = 5.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "StatusEffect")
+	TSubclassOf<UDamageType> DamageType;
+};
+
+//Compact start record replicated to clients, the effect stops when its record is removed
+USTRUCT()
+struct FStatusEffectRecord
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	uint16 Handle = 0;
+
+	UPROPERTY()
+	EStatusEffectKind Kind = EStatusEffectKind::Burning;
+
+	//Server world time the effect started at
+	UPROPERTY()
+	float StartTime = 0.0f;
+
+	UPROPERTY()
+	float Duration = 0.0f;
+
+	UPROPERTY()
+	float HealthPerSecond = 0.0f;
+};
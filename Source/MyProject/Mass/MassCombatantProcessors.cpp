@@ -0,0 +1,389 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../Mass/MassCombatantProcessors.h"
+
+#include <atomic>
+
+#include "../Components/HealthComponent.h"
+#include "../Mass/MassCombatantSubsystem.h"
+#include "../Mass/MassCombatantTypes.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
+#include "MassCommonFragments.h"
+#include "MassExecutionContext.h"
+
+static TAutoConsoleVariable<float> CVarMassPromoteDistance(
+	TEXT("mp.Mass.PromoteDistance"),
+	5000.0f,
+	TEXT("Combatants closer than this to a player pawn are represented by an actor."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarMassDemoteDistance(
+	TEXT("mp.Mass.DemoteDistance"),
+	6000.0f,
+	TEXT("Promoted combatants farther than this from every player pawn go back to plain entities."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarMassPromotionInterval(
+	TEXT("mp.Mass.PromotionInterval"),
+	0.25f,
+	TEXT("Seconds between promotion and demotion checks."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMassMaxPromoted(
+	TEXT("mp.Mass.MaxPromoted"),
+	32,
+	TEXT("Upper bound of combatants represented by actors at the same time."),
+	ECVF_Default);
+
+static FMassEntityHandle FindNearestEnemy(const TArray<FMassCombatantSnapshot>& Enemies, const FVector& Location)
+{
+	FMassEntityHandle Nearest;
+	float NearestDistSq = MAX_flt;
+	for(const FMassCombatantSnapshot& Enemy : Enemies)
+	{
+		const float DistSq = FVector::DistSquared2D(Enemy.Location, Location);
+		if(DistSq < NearestDistSq)
+		{
+			NearestDistSq = DistSq;
+			Nearest = Enemy.Entity;
+		}
+	}
+	return Nearest;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Movement
+
+UMassCombatantMovementProcessor::UMassCombatantMovementProcessor()
+{
+	bAutoRegisterWithProcessingPhases = true;
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::Server | EProcessorExecutionFlags::Standalone);
+	ProcessingPhase = EMassProcessingPhase::PrePhysics;
+}
+
+void UMassCombatantMovementProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FMassCombatantTargetFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddConstSharedRequirement<FMassCombatantParams>();
+	EntityQuery.RegisterWithProcessor(*this);
+	ProcessorRequirements.AddSubsystemRequirement<UMassCombatantSubsystem>(EMassFragmentAccess::ReadWrite);
+}
+
+void UMassCombatantMovementProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	UWorld* World = EntityManager.GetWorld();
+	UMassCombatantSubsystem* Combatants = &Context.GetMutableSubsystemChecked<UMassCombatantSubsystem>();
+
+	//Every location from before this frame's moves, so the parallel pass below only reads shared data
+	Combatants->ResetSnapshot();
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [Combatants](FMassExecutionContext& Context)
+	{
+		const int32 Team = Context.GetConstSharedFragment<FMassCombatantParams>().Team;
+		const TConstArrayView<FTransformFragment> Transforms = Context.GetFragmentView<FTransformFragment>();
+		for(int32 i = 0; i < Context.GetNumEntities(); ++i)
+		{
+			Combatants->AddToSnapshot(Team, Context.GetEntity(i), Transforms[i].GetTransform().GetLocation());
+		}
+	});
+
+	const double Now = World->GetTimeSeconds();
+	EntityQuery.ParallelForEachEntityChunk(EntityManager, Context, [Combatants, Now](FMassExecutionContext& Context)
+	{
+		const FMassCombatantParams& Params = Context.GetConstSharedFragment<FMassCombatantParams>();
+		const TArray<FMassCombatantSnapshot>& Enemies = Combatants->GetTeam(1 - Params.Team);
+		const TArrayView<FTransformFragment> Transforms = Context.GetMutableFragmentView<FTransformFragment>();
+		const TArrayView<FMassCombatantTargetFragment> Targets = Context.GetMutableFragmentView<FMassCombatantTargetFragment>();
+		const float MaxStep = Params.MoveSpeed * Context.GetDeltaTimeSeconds();
+		//Promoted actors move themselves, their entities only pick targets and follow the actor
+		const bool bPromoted = Context.DoesArchetypeHaveTag<FMassCombatantPromotedTag>();
+
+		for(int32 i = 0; i < Context.GetNumEntities(); ++i)
+		{
+			FTransform& Transform = Transforms[i].GetMutableTransform();
+			FMassCombatantTargetFragment& Target = Targets[i];
+			const FVector Location = Transform.GetLocation();
+
+			const FVector* TargetLocation = Target.Entity.IsSet() ? Combatants->FindLocation(Target.Entity) : nullptr;
+			if(!TargetLocation || Now >= Target.RetargetTime)
+			{
+				Target.Entity = FindNearestEnemy(Enemies, Location);
+				//Spread retargeting over several frames
+				Target.RetargetTime = Now + Params.RetargetInterval * (1.0f + (Context.GetEntity(i).Index & 7) / 8.0f);
+				TargetLocation = Target.Entity.IsSet() ? Combatants->FindLocation(Target.Entity) : nullptr;
+			}
+			if(!TargetLocation)
+			{
+				Target.Entity.Reset();
+				Target.bInRange = false;
+				continue;
+			}
+			Target.Location = *TargetLocation;
+
+			const FVector ToTarget = (Target.Location - Location) * FVector(1.0f, 1.0f, 0.0f);
+			const float Distance = ToTarget.Size();
+			Target.bInRange = Distance <= Params.EngageRange;
+			if(!bPromoted && Distance > KINDA_SMALL_NUMBER)
+			{
+				const FVector Direction = ToTarget / Distance;
+				Transform.SetRotation(Direction.ToOrientationQuat());
+				if(!Target.bInRange)
+				{
+					Transform.SetLocation(Location + Direction * FMath::Min(MaxStep, Distance - Params.EngageRange));
+				}
+			}
+		}
+	});
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Fire
+
+UMassCombatantFireProcessor::UMassCombatantFireProcessor()
+{
+	bAutoRegisterWithProcessingPhases = true;
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::Server | EProcessorExecutionFlags::Standalone);
+	ProcessingPhase = EMassProcessingPhase::PrePhysics;
+	ExecutionOrder.ExecuteAfter.Add(UMassCombatantMovementProcessor::StaticClass()->GetFName());
+}
+
+void UMassCombatantFireProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FMassCombatantWeaponFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FMassCombatantTargetFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddConstSharedRequirement<FMassCombatantParams>();
+	EntityQuery.RegisterWithProcessor(*this);
+	ProcessorRequirements.AddSubsystemRequirement<UMassCombatantSubsystem>(EMassFragmentAccess::ReadWrite);
+}
+
+void UMassCombatantFireProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	UWorld* World = EntityManager.GetWorld();
+	UMassCombatantSubsystem* Combatants = &Context.GetMutableSubsystemChecked<UMassCombatantSubsystem>();
+
+	const double Now = World->GetTimeSeconds();
+	EntityQuery.ParallelForEachEntityChunk(EntityManager, Context, [Combatants, Now](FMassExecutionContext& Context)
+	{
+		const FMassCombatantParams& Params = Context.GetConstSharedFragment<FMassCombatantParams>();
+		const FWeaponSimConfig Config = Params.GetWeaponConfig();
+		const TArrayView<FMassCombatantWeaponFragment> Weapons = Context.GetMutableFragmentView<FMassCombatantWeaponFragment>();
+		const TConstArrayView<FMassCombatantTargetFragment> Targets = Context.GetFragmentView<FMassCombatantTargetFragment>();
+		const double FrameStart = Now - Context.GetDeltaTimeSeconds();
+
+		TArray<FMassCombatantHit, TInlineAllocator<64>> Hits;
+		for(int32 i = 0; i < Context.GetNumEntities(); ++i)
+		{
+			const FMassCombatantTargetFragment& Target = Targets[i];
+			if(!Target.bInRange)
+			{
+				continue;
+			}
+			FMassCombatantWeaponFragment& Weapon = Weapons[i];
+			if(!Weapon.State.bCanFire)
+			{
+				if(Now < Weapon.ReloadEndTime)
+				{
+					continue;
+				}
+				Weapon.State.Reload(Config);
+			}
+
+			//Several shots per frame at high fire rates, each placed at its own time in the frame
+			while(Weapon.State.bCanFire && Weapon.State.GetFireDelay(Config, Now) <= 0.0)
+			{
+				const double ShotTime = FMath::Max(Weapon.State.LastTimeFired + Config.GetTimeBetweenShots(), FrameStart);
+				if(Weapon.State.ConsumeShot(ShotTime))
+				{
+					Weapon.ReloadEndTime = ShotTime + Config.ReloadTime;
+				}
+				FRandomStream Random(HashCombine(GetTypeHash(Context.GetEntity(i)), GetTypeHash(ShotTime)));
+				if(Random.FRand() < Params.Accuracy)
+				{
+					Hits.Add({Target.Entity, Config.BaseDamage});
+				}
+			}
+		}
+		Combatants->AddHits(Hits);
+	});
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Damage
+
+UMassCombatantDamageProcessor::UMassCombatantDamageProcessor()
+{
+	bAutoRegisterWithProcessingPhases = true;
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::Server | EProcessorExecutionFlags::Standalone);
+	ProcessingPhase = EMassProcessingPhase::PrePhysics;
+	ExecutionOrder.ExecuteAfter.Add(UMassCombatantFireProcessor::StaticClass()->GetFName());
+	//Hits on promoted actors go through UGameplayStatics::ApplyDamage
+	bRequiresGameThreadExecution = true;
+}
+
+void UMassCombatantDamageProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FMassCombatantHealthFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddTagRequirement<FMassCombatantPromotedTag>(EMassFragmentPresence::None);
+	EntityQuery.RegisterWithProcessor(*this);
+	ProcessorRequirements.AddSubsystemRequirement<UMassCombatantSubsystem>(EMassFragmentAccess::ReadWrite);
+}
+
+void UMassCombatantDamageProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	UMassCombatantSubsystem* Combatants = &Context.GetMutableSubsystemChecked<UMassCombatantSubsystem>();
+	const TArray<FMassCombatantHit> Hits = Combatants->ConsumeHits();
+	if(Hits.Num() == 0)
+	{
+		return;
+	}
+
+	TMap<FMassEntityHandle, float> DamageByTarget;
+	for(const FMassCombatantHit& Hit : Hits)
+	{
+		if(AActor* Actor = Combatants->FindPromotedActor(Hit.Target))
+		{
+			UGameplayStatics::ApplyDamage(Actor, Hit.Damage, nullptr, nullptr, UDamageType::StaticClass());
+		}
+		else
+		{
+			DamageByTarget.FindOrAdd(Hit.Target) += Hit.Damage;
+		}
+	}
+	if(DamageByTarget.Num() == 0)
+	{
+		return;
+	}
+
+	std::atomic<int32> NumKilled{0};
+	EntityQuery.ParallelForEachEntityChunk(EntityManager, Context, [&DamageByTarget, &NumKilled](FMassExecutionContext& Context)
+	{
+		const TArrayView<FMassCombatantHealthFragment> Healths = Context.GetMutableFragmentView<FMassCombatantHealthFragment>();
+		for(int32 i = 0; i < Context.GetNumEntities(); ++i)
+		{
+			const FMassEntityHandle Entity = Context.GetEntity(i);
+			const float* Damage = DamageByTarget.Find(Entity);
+			if(!Damage || Healths[i].State.IsDead())
+			{
+				continue;
+			}
+			Healths[i].State.ApplyDamage(*Damage);
+			if(Healths[i].State.IsDead())
+			{
+				Context.Defer().DestroyEntity(Entity);
+				NumKilled.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	});
+	Combatants->AddKills(NumKilled.load());
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Promotion
+
+UMassCombatantPromotionProcessor::UMassCombatantPromotionProcessor()
+{
+	bAutoRegisterWithProcessingPhases = true;
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::Server | EProcessorExecutionFlags::Standalone);
+	ProcessingPhase = EMassProcessingPhase::PrePhysics;
+	ExecutionOrder.ExecuteAfter.Add(UMassCombatantDamageProcessor::StaticClass()->GetFName());
+	bRequiresGameThreadExecution = true;
+}
+
+void UMassCombatantPromotionProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FMassCombatantHealthFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddConstSharedRequirement<FMassCombatantParams>();
+	EntityQuery.RegisterWithProcessor(*this);
+	ProcessorRequirements.AddSubsystemRequirement<UMassCombatantSubsystem>(EMassFragmentAccess::ReadWrite);
+}
+
+void UMassCombatantPromotionProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	UWorld* World = EntityManager.GetWorld();
+	UMassCombatantSubsystem* Combatants = &Context.GetMutableSubsystemChecked<UMassCombatantSubsystem>();
+
+	TimeUntilUpdate -= Context.GetDeltaTimeSeconds();
+	const bool bCheckDistances = TimeUntilUpdate <= 0.0f;
+	TArray<FVector, TInlineAllocator<16>> PlayerLocations;
+	if(bCheckDistances)
+	{
+		TimeUntilUpdate = CVarMassPromotionInterval.GetValueOnGameThread();
+		for(FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+		{
+			if(const APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+			{
+				PlayerLocations.Add(Pawn->GetActorLocation());
+			}
+		}
+	}
+	auto IsNearPlayer = [&PlayerLocations](const FVector& Location, float Distance)
+	{
+		const float DistanceSq = Distance * Distance;
+		for(const FVector& PlayerLocation : PlayerLocations)
+		{
+			if(FVector::DistSquared(PlayerLocation, Location) <= DistanceSq)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+	const float PromoteDistance = CVarMassPromoteDistance.GetValueOnGameThread();
+	const float DemoteDistance = FMath::Max(CVarMassDemoteDistance.GetValueOnGameThread(), PromoteDistance);
+	const int32 MaxPromoted = CVarMassMaxPromoted.GetValueOnGameThread();
+
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [&](FMassExecutionContext& Context)
+	{
+		const FMassCombatantParams& Params = Context.GetConstSharedFragment<FMassCombatantParams>();
+		const TArrayView<FTransformFragment> Transforms = Context.GetMutableFragmentView<FTransformFragment>();
+		const TArrayView<FMassCombatantHealthFragment> Healths = Context.GetMutableFragmentView<FMassCombatantHealthFragment>();
+		const bool bPromoted = Context.DoesArchetypeHaveTag<FMassCombatantPromotedTag>();
+
+		for(int32 i = 0; i < Context.GetNumEntities(); ++i)
+		{
+			const FMassEntityHandle Entity = Context.GetEntity(i);
+			FTransform& Transform = Transforms[i].GetMutableTransform();
+			FHealthSimState& Health = Healths[i].State;
+
+			if(bPromoted)
+			{
+				AActor* Actor = Combatants->FindPromotedActor(Entity);
+				UHealthComponent* HealthComp = Actor ? Actor->FindComponentByClass<UHealthComponent>() : nullptr;
+				if(!Actor || (HealthComp && HealthComp->IsDead()))
+				{
+					//Killed as an actor, the actor keeps its own death handling
+					Combatants->ForgetPromoted(Entity);
+					Combatants->AddKills(1);
+					Context.Defer().DestroyEntity(Entity);
+					continue;
+				}
+				if(HealthComp)
+				{
+					Health.Health = HealthComp->GetHealth();
+				}
+				//The actor was placed once when promoted, from then on the entity follows it for targeting and demotion
+				Transform.SetLocation(Actor->GetActorLocation());
+				Transform.SetRotation(Actor->GetActorQuat());
+
+				if(bCheckDistances && !IsNearPlayer(Transform.GetLocation(), DemoteDistance))
+				{
+					Health.Health = Combatants->Demote(Entity, Health.Health);
+					Context.Defer().RemoveTag<FMassCombatantPromotedTag>(Entity);
+				}
+			}
+			else if(bCheckDistances && Params.PromotedActorClass && Combatants->GetNumPromoted() < MaxPromoted
+				&& IsNearPlayer(Transform.GetLocation(), PromoteDistance))
+			{
+				if(Combatants->Promote(Entity, Params.PromotedActorClass, Transform, Health.Health))
+				{
+					Context.Defer().AddTag<FMassCombatantPromotedTag>(Entity);
+				}
+			}
+		}
+	});
+}
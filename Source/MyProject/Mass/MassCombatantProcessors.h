@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityQuery.h"
+#include "MassProcessor.h"
+#include "MassCombatantProcessors.generated.h"
+
+/** Snapshots every combatant's location, then picks the nearest enemy and walks into engage range */
+UCLASS()
+class MYPROJECT_API UMassCombatantMovementProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+
+	UMassCombatantMovementProcessor();
+
+protected:
+
+	virtual void ConfigureQueries() override;
+
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	FMassEntityQuery EntityQuery;
+};
+
+/** Fires at the target with the same cadence and magazine rules as AWeaponBase, hits are collected for the damage processor */
+UCLASS()
+class MYPROJECT_API UMassCombatantFireProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+
+	UMassCombatantFireProcessor();
+
+protected:
+
+	virtual void ConfigureQueries() override;
+
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	FMassEntityQuery EntityQuery;
+};
+
+/** Applies this frame's hits, entities go through FHealthSimState and promoted actors through their UHealthComponent */
+UCLASS()
+class MYPROJECT_API UMassCombatantDamageProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+
+	UMassCombatantDamageProcessor();
+
+protected:
+
+	virtual void ConfigureQueries() override;
+
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	FMassEntityQuery EntityQuery;
+};
+
+/**
+ * Spawns an actor for entities within mp.Mass.PromoteDistance of a player pawn and removes it beyond mp.Mass.DemoteDistance.
+ * The actor is placed at the entity once, while promoted the entity follows the actor and takes its health from it.
+ */
+UCLASS()
+class MYPROJECT_API UMassCombatantPromotionProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+
+	UMassCombatantPromotionProcessor();
+
+protected:
+
+	virtual void ConfigureQueries() override;
+
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	FMassEntityQuery EntityQuery;
+
+	float TimeUntilUpdate = 0.0f;
+};
@@ -0,0 +1,158 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../Mass/MassCombatantSubsystem.h"
+
+#include "../Components/HealthComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "MassCommonFragments.h"
+#include "MassEntityConfigAsset.h"
+#include "MassEntityUtils.h"
+#include "MassSpawnerSubsystem.h"
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice MassCombatantsCommand(
+	TEXT("mp.Mass.Combatants"),
+	TEXT("Print the number of living, promoted and killed Mass combatants."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if(const UMassCombatantSubsystem* Combatants = World ? World->GetSubsystem<UMassCombatantSubsystem>() : nullptr)
+		{
+			Combatants->Dump(Ar);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice MassSpawnCombatantsCommand(
+	TEXT("mp.Mass.SpawnCombatants"),
+	TEXT("mp.Mass.SpawnCombatants <EntityConfigAsset> <Count> [Radius], spawns around the first player."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		UMassCombatantSubsystem* Combatants = World ? World->GetSubsystem<UMassCombatantSubsystem>() : nullptr;
+		if(!Combatants || Args.Num() < 2)
+		{
+			Ar.Log(TEXT("Usage: mp.Mass.SpawnCombatants <EntityConfigAsset> <Count> [Radius]"));
+			return;
+		}
+		const UMassEntityConfigAsset* Config = LoadObject<UMassEntityConfigAsset>(nullptr, *Args[0]);
+		if(!Config)
+		{
+			Ar.Logf(TEXT("Entity config %s not found"), *Args[0]);
+			return;
+		}
+		FVector Origin = FVector::ZeroVector;
+		const APlayerController* PlayerController = World->GetFirstPlayerController();
+		if(PlayerController && PlayerController->GetPawn())
+		{
+			Origin = PlayerController->GetPawn()->GetActorLocation();
+		}
+		const float Radius = Args.Num() > 2 ? FCString::Atof(*Args[2]) : 10000.0f;
+		const int32 NumSpawned = Combatants->SpawnCombatants(Config, FCString::Atoi(*Args[1]), Origin, Radius);
+		Ar.Logf(TEXT("Spawned %d combatants"), NumSpawned);
+	}));
+
+bool UMassCombatantSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+int32 UMassCombatantSubsystem::SpawnCombatants(const UMassEntityConfigAsset* Config, int32 Count, const FVector& Origin,
+	float Radius)
+{
+	UWorld* World = GetWorld();
+	UMassSpawnerSubsystem* Spawner = World->GetSubsystem<UMassSpawnerSubsystem>();
+	if(!Config || !Spawner || Count <= 0 || World->GetNetMode() == NM_Client)
+	{
+		return 0;
+	}
+	const FMassEntityTemplate& Template = Config->GetOrCreateEntityTemplate(*World);
+	if(!Template.IsValid())
+	{
+		return 0;
+	}
+
+	TArray<FMassEntityHandle> Entities;
+	Spawner->SpawnEntities(Template, Count, Entities);
+
+	FMassEntityManager& EntityManager = UE::Mass::Utils::GetEntityManagerChecked(*World);
+	for(const FMassEntityHandle Entity : Entities)
+	{
+		const FVector2D Offset = FMath::RandPointInCircle(Radius);
+		EntityManager.GetFragmentDataChecked<FTransformFragment>(Entity).SetTransform(FTransform(Origin + FVector(Offset, 0.0f)));
+	}
+	return Entities.Num();
+}
+
+void UMassCombatantSubsystem::ResetSnapshot()
+{
+	Teams[0].Reset();
+	Teams[1].Reset();
+	Locations.Reset();
+}
+
+void UMassCombatantSubsystem::AddToSnapshot(int32 Team, FMassEntityHandle Entity, const FVector& Location)
+{
+	Teams[Team & 1].Add({Entity, Location});
+	Locations.Add(Entity, Location);
+}
+
+void UMassCombatantSubsystem::AddHits(TConstArrayView<FMassCombatantHit> Hits)
+{
+	if(Hits.Num() > 0)
+	{
+		FScopeLock Lock(&PendingHitsLock);
+		PendingHits.Append(Hits.GetData(), Hits.Num());
+	}
+}
+
+TArray<FMassCombatantHit> UMassCombatantSubsystem::ConsumeHits()
+{
+	FScopeLock Lock(&PendingHitsLock);
+	return MoveTemp(PendingHits);
+}
+
+AActor* UMassCombatantSubsystem::Promote(FMassEntityHandle Entity, TSubclassOf<AActor> ActorClass, const FTransform& Transform,
+	float Health)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	AActor* Actor = GetWorld()->SpawnActor<AActor>(ActorClass, Transform, SpawnParams);
+	if(!Actor)
+	{
+		return nullptr;
+	}
+	if(UHealthComponent* HealthComp = Actor->FindComponentByClass<UHealthComponent>())
+	{
+		HealthComp->SetHealth(Health);
+	}
+	PromotedActors.Add(Entity, Actor);
+	return Actor;
+}
+
+float UMassCombatantSubsystem::Demote(FMassEntityHandle Entity, float FallbackHealth)
+{
+	TWeakObjectPtr<AActor> WeakActor;
+	if(!PromotedActors.RemoveAndCopyValue(Entity, WeakActor) || !WeakActor.IsValid())
+	{
+		return FallbackHealth;
+	}
+	float Health = FallbackHealth;
+	if(UHealthComponent* HealthComp = WeakActor->FindComponentByClass<UHealthComponent>())
+	{
+		Health = HealthComp->GetHealth();
+	}
+	WeakActor->Destroy();
+	return Health;
+}
+
+AActor* UMassCombatantSubsystem::FindPromotedActor(FMassEntityHandle Entity) const
+{
+	const TWeakObjectPtr<AActor>* WeakActor = PromotedActors.Find(Entity);
+	return WeakActor ? WeakActor->Get() : nullptr;
+}
+
+void UMassCombatantSubsystem::Dump(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("Combatants: team 0 %d, team 1 %d, promoted %d, killed %d"), Teams[0].Num(), Teams[1].Num(),
+		PromotedActors.Num(), NumKilled);
+}
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MassExternalSubsystemTraits.h"
+#include "../Mass/MassCombatantTypes.h"
+#include "MassCombatantSubsystem.generated.h"
+
+class UMassEntityConfigAsset;
+
+/**
+ * Per frame state shared between the combatant processors: where every living combatant is, the hits
+ * fired this frame and the actors that currently stand in for promoted entities.
+ */
+UCLASS()
+class MYPROJECT_API UMassCombatantSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	//Spawns Count entities from Config scattered within Radius of Origin
+	int32 SpawnCombatants(const UMassEntityConfigAsset* Config, int32 Count, const FVector& Origin, float Radius);
+
+	//Not thread safe, only the movement processor writes the snapshot and it does so serially before its own parallel pass.
+	//Every combatant processor declares read write access to this subsystem so Mass never runs two of them at once
+	void ResetSnapshot();
+
+	void AddToSnapshot(int32 Team, FMassEntityHandle Entity, const FVector& Location);
+
+	const TArray<FMassCombatantSnapshot>& GetTeam(int32 Team) const {return Teams[Team & 1];}
+
+	const FVector* FindLocation(FMassEntityHandle Entity) const {return Locations.Find(Entity);}
+
+	//Thread safe, called once per chunk by the fire processor
+	void AddHits(TConstArrayView<FMassCombatantHit> Hits);
+
+	TArray<FMassCombatantHit> ConsumeHits();
+
+	AActor* Promote(FMassEntityHandle Entity, TSubclassOf<AActor> ActorClass, const FTransform& Transform, float Health);
+
+	//Returns the health of the actor before it was destroyed
+	float Demote(FMassEntityHandle Entity, float FallbackHealth);
+
+	AActor* FindPromotedActor(FMassEntityHandle Entity) const;
+
+	void ForgetPromoted(FMassEntityHandle Entity) {PromotedActors.Remove(Entity);}
+
+	int32 GetNumPromoted() const {return PromotedActors.Num();}
+
+	void AddKills(int32 Count) {NumKilled += Count;}
+
+	void Dump(FOutputDevice& Ar) const;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	TArray<FMassCombatantSnapshot> Teams[2];
+
+	TMap<FMassEntityHandle, FVector> Locations;
+
+	TArray<FMassCombatantHit> PendingHits;
+
+	FCriticalSection PendingHitsLock;
+
+	TMap<FMassEntityHandle, TWeakObjectPtr<AActor>> PromotedActors;
+
+	int32 NumKilled = 0;
+};
+
+template<>
+struct TMassExternalSubsystemTraits<UMassCombatantSubsystem>
+{
+	enum
+	{
+		//Processors may use it from any thread, hits are guarded by PendingHitsLock but the snapshot is not
+		GameThreadOnly = false,
+		ThreadSafeWrite = false,
+	};
+};
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../Mass/MassCombatantTrait.h"
+
+#include "MassCommonFragments.h"
+#include "MassEntityTemplateRegistry.h"
+#include "MassEntityUtils.h"
+
+void UMassCombatantTrait::BuildTemplate(FMassEntityTemplateBuildContext& BuildContext, const UWorld& World) const
+{
+	FMassEntityManager& EntityManager = UE::Mass::Utils::GetEntityManagerChecked(World);
+
+	BuildContext.AddFragment<FTransformFragment>();
+	BuildContext.AddFragment<FMassCombatantTargetFragment>();
+
+	FMassCombatantHealthFragment& Health = BuildContext.AddFragment_GetRef<FMassCombatantHealthFragment>();
+	Health.State.MaxHealth = Params.MaxHealth;
+	Health.State.Health = Params.MaxHealth;
+
+	FMassCombatantWeaponFragment& Weapon = BuildContext.AddFragment_GetRef<FMassCombatantWeaponFragment>();
+	Weapon.State.Reset(Params.GetWeaponConfig());
+
+	BuildContext.AddConstSharedFragment(EntityManager.GetOrCreateConstSharedFragment(Params));
+}
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTraitBase.h"
+#include "../Mass/MassCombatantTypes.h"
+#include "MassCombatantTrait.generated.h"
+
+/**
+ * Adds the combatant fragments to a Mass entity config. Two configs with different teams make a fight,
+ * spawn them with a MassSpawner or mp.Mass.SpawnCombatants.
+ */
+UCLASS(meta = (DisplayName = "Combatant"))
+class MYPROJECT_API UMassCombatantTrait : public UMassEntityTraitBase
+{
+	GENERATED_BODY()
+
+protected:
+
+	virtual void BuildTemplate(FMassEntityTemplateBuildContext& BuildContext, const UWorld& World) const override;
+
+	UPROPERTY(EditAnywhere, Category = "Combatant")
+	FMassCombatantParams Params;
+};
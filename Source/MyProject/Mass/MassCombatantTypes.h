@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "../Simulation/CombatSim.h"
+#include "MassCombatantTypes.generated.h"
+
+USTRUCT()
+struct FMassCombatantHealthFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FHealthSimState State;
+};
+
+USTRUCT()
+struct FMassCombatantWeaponFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FWeaponSimState State;
+
+	double ReloadEndTime = 0.0;
+};
+
+USTRUCT()
+struct FMassCombatantTargetFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FMassEntityHandle Entity;
+
+	FVector Location = FVector::ZeroVector;
+
+	double RetargetTime = 0.0;
+
+	bool bInRange = false;
+};
+
+//The entity is represented by a spawned actor, see UMassCombatantPromotionProcessor
+USTRUCT()
+struct FMassCombatantPromotedTag : public FMassTag
+{
+	GENERATED_BODY()
+};
+
+/** Settings shared by every combatant built from the same trait */
+USTRUCT()
+struct FMassCombatantParams : public FMassSharedFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Combatant", meta = (ClampMin = 0, ClampMax = 1))
+	int32 Team = 0;
+
+	UPROPERTY(EditAnywhere, Category = "Combatant", meta = (ClampMin = 1))
+	float MaxHealth = 100.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Combatant|Weapon")
+	float BaseDamage = 20.0f;
+
+	//Rounds per minute
+	UPROPERTY(EditAnywhere, Category = "Combatant|Weapon", meta = (ClampMin = 1))
+	float FireRate = 600.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Combatant|Weapon", meta = (ClampMin = 1))
+	int32 MaxMagCapacity = 30;
+
+	UPROPERTY(EditAnywhere, Category = "Combatant|Weapon", meta = (ClampMin = 0))
+	float ReloadTime = 2.0f;
+
+	//Chance for a single shot to hit
+	UPROPERTY(EditAnywhere, Category = "Combatant|Weapon", meta = (ClampMin = 0, ClampMax = 1))
+	float Accuracy = 0.3f;
+
+	UPROPERTY(EditAnywhere, Category = "Combatant|Movement", meta = (ClampMin = 0))
+	float MoveSpeed = 500.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Combatant|Movement", meta = (ClampMin = 0))
+	float EngageRange = 2500.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Combatant|Movement", meta = (ClampMin = 0.1))
+	float RetargetInterval = 1.0f;
+
+	//Spawned in place of the entity near players, a UHealthComponent on it receives the entity's health
+	UPROPERTY(EditAnywhere, Category = "Combatant")
+	TSubclassOf<AActor> PromotedActorClass;
+
+	FWeaponSimConfig GetWeaponConfig() const
+	{
+		FWeaponSimConfig Config;
+		Config.BaseDamage = BaseDamage;
+		Config.FireRate = FireRate;
+		Config.MaxMagCapacity = MaxMagCapacity;
+		Config.ReloadTime = ReloadTime;
+		return Config;
+	}
+};
+
+struct FMassCombatantSnapshot
+{
+	FMassEntityHandle Entity;
+
+	FVector Location;
+};
+
+struct FMassCombatantHit
+{
+	FMassEntityHandle Target;
+
+	float Damage;
+};
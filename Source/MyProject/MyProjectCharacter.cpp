@@ -15,14 +15,19 @@
 #include "PropertyPathHelpers.h"
 #include "Channels/MovieSceneChannelTraits.h"
 #include "Weapons/WeaponBase.h"
+#include "Components/MyProjectCharacterMovementComponent.h"
 #include "Net/UnrealNetwork.h"
+#include "Subsystems/NetBandwidthTelemetrySubsystem.h"
+#include "Subsystems/ServerBudgetGovernorSubsystem.h"
+#include "Telemetry/MatchTelemetrySubsystem.h"
 
 DEFINE_LOG_CATEGORY(LogTemplateCharacter);
 
 //////////////////////////////////////////////////////////////////////////
 // AMTPSCharacter
 
-AMyProjectCharacter::AMyProjectCharacter()
+AMyProjectCharacter::AMyProjectCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UMyProjectCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
@@ -74,14 +79,7 @@ void AMyProjectCharacter::BeginPlay()
 	//Spawn a default weapon
 	if(GetLocalRole() == ROLE_Authority)
 	{
-		FActorSpawnParameters SpawnParameters;
-		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-		CurrentWeapon = GetWorld()->SpawnActor<AWeaponBase>(StarerWeaponClass, FVector::ZeroVector, FRotator::ZeroRotator, SpawnParameters);
-		if(CurrentWeapon)
-		{
-			CurrentWeapon->SetOwner(this);
-			CurrentWeapon->AttachToComponent(GetMesh(), FAttachmentTransformRules::SnapToTargetIncludingScale, "WeaponSocket");
-		}
+		CurrentWeapon = FindOrSpawnWeapon(StarerWeaponClass);
 	}
 	//Add Input Mapping Context
 	if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
@@ -112,6 +110,11 @@ FVector AMyProjectCharacter::GetPawnViewLocation() const
 	return Super::GetPawnViewLocation();
 }
 
+UMyProjectCharacterMovementComponent* AMyProjectCharacter::GetMyCharacterMovement() const
+{
+	return CastChecked<UMyProjectCharacterMovementComponent>(GetCharacterMovement());
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Input
 
@@ -162,6 +165,8 @@ void AMyProjectCharacter::OnHealthChange(UHealthComponent* HealthComp, float Hea
 	if(Health <= 0.0f && !bDied)
 	{
 		bDied = true;
+		UMatchTelemetrySubsystem::Record(this, ECombatTelemetryEvent::Death, this, nullptr, DamageCauser);
+		UMatchTelemetrySubsystem::Record(this, ECombatTelemetryEvent::Kill, InstigatedBy ? InstigatedBy->GetPawn() : nullptr, this, DamageCauser);
 		Dying();
 	}
 }
@@ -220,23 +225,26 @@ void AMyProjectCharacter::StopFire()
 
 void AMyProjectCharacter::StartSprint()
 {
-	GetCharacterMovement()->MaxWalkSpeed = 700.f;
+	//Speed comes from the movement component, which sends the flag with every saved move
+	GetMyCharacterMovement()->SetWantsToSprint(true);
 	bIsSprinting = true;
 }
 
 void AMyProjectCharacter::StopSprint()
 {
-	GetCharacterMovement()->MaxWalkSpeed = 500.f;
+	GetMyCharacterMovement()->SetWantsToSprint(false);
 	bIsSprinting = false;
 }
 
 void AMyProjectCharacter::BeginZoom()
 {
+	GetMyCharacterMovement()->SetWantsToAim(true);
 	bWantsToZoom = true;
 }
 
 void AMyProjectCharacter::EndZoom()
 {
+	GetMyCharacterMovement()->SetWantsToAim(false);
 	bWantsToZoom = false;
 }
 
@@ -252,45 +260,93 @@ void AMyProjectCharacter::Dying()
 {
 	GetMovementComponent()->StopMovementImmediately();
 	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	GetMesh()->SetSimulatePhysics(true);
+	//A ragdoll on a dedicated server is only for show
+	if(!IsNetMode(NM_DedicatedServer) || !UServerBudgetGovernorSubsystem::ShouldSkipCosmetics(this))
+	{
+		GetMesh()->SetSimulatePhysics(true);
+	}
 	DetachFromControllerPendingDestroy();
 	SetLifeSpan(10.0f);
 }
 
+void AMyProjectCharacter::OnRep_Died()
+{
+	if(bDied)
+	{
+		GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		GetMesh()->SetSimulatePhysics(true);
+	}
+}
+
 void AMyProjectCharacter::FirstWeapon()
 {
-	if(CurrentWeapon)
+	if(WeaponArray.IsValidIndex(0))
+	{
+		EquipWeapon(WeaponArray[0]);
+	}
+}
+
+void AMyProjectCharacter::SecondWeapon()
+{
+	if(WeaponArray.IsValidIndex(1))
 	{
-		AWeaponBase* OldWeapon = CurrentWeapon;
+		EquipWeapon(WeaponArray[1]);
+	}
+}
 
-		FActorSpawnParameters SpawnParameters;
-		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-		CurrentWeapon = GetWorld()->SpawnActor<AWeaponBase>(WeaponArray[0], FVector::ZeroVector, FRotator::ZeroRotator, SpawnParameters);
-		if(CurrentWeapon)
+AWeaponBase* AMyProjectCharacter::FindOrSpawnWeapon(TSubclassOf<AWeaponBase> WeaponClass)
+{
+	for(AWeaponBase* Weapon : WeaponInventory)
+	{
+		if(Weapon && Weapon->GetClass() == WeaponClass)
 		{
-			CurrentWeapon->SetOwner(this);
-			CurrentWeapon->AttachToComponent(GetMesh(), FAttachmentTransformRules::SnapToTargetIncludingScale, "WeaponSocket");
-			OldWeapon->Destroy();
+			return Weapon;
 		}
 	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AWeaponBase* Weapon = GetWorld()->SpawnActor<AWeaponBase>(WeaponClass, FVector::ZeroVector, FRotator::ZeroRotator, SpawnParameters);
+	if(Weapon)
+	{
+		Weapon->SetOwner(this);
+		Weapon->AttachToComponent(GetMesh(), FAttachmentTransformRules::SnapToTargetIncludingScale, "WeaponSocket");
+		WeaponInventory.Add(Weapon);
+	}
+	return Weapon;
 }
 
-void AMyProjectCharacter::SecondWeapon()
+void AMyProjectCharacter::EquipWeapon(TSubclassOf<AWeaponBase> WeaponClass)
 {
-	if(CurrentWeapon)
+	if(!CurrentWeapon || !WeaponClass || CurrentWeapon->GetClass() == WeaponClass)
+	{
+		return;
+	}
+
+	//Switched out weapons are kept hidden instead of destroyed, so swapping creates no garbage
+	AWeaponBase* NewWeapon = FindOrSpawnWeapon(WeaponClass);
+	if(NewWeapon)
 	{
-		AWeaponBase* OldWeapon = CurrentWeapon;
+		CurrentWeapon->StopFire();
+		CurrentWeapon->SetActorHiddenInGame(true);
+		CurrentWeapon = NewWeapon;
+		CurrentWeapon->SetActorHiddenInGame(false);
+		UMatchTelemetrySubsystem::Record(this, ECombatTelemetryEvent::WeaponSwitch, this, nullptr, CurrentWeapon);
+	}
+}
 
-		FActorSpawnParameters SpawnParameters;
-		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-		CurrentWeapon = GetWorld()->SpawnActor<AWeaponBase>(WeaponArray[1], FVector::ZeroVector, FRotator::ZeroRotator, SpawnParameters);
-		if(CurrentWeapon)
+void AMyProjectCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	//Attached weapons are not destroyed with the character
+	for(AWeaponBase* Weapon : WeaponInventory)
+	{
+		if(Weapon)
 		{
-			CurrentWeapon->SetOwner(this);
-			CurrentWeapon->AttachToComponent(GetMesh(), FAttachmentTransformRules::SnapToTargetIncludingScale, "WeaponSocket");
-			OldWeapon->Destroy();
+			Weapon->Destroy();
 		}
 	}
+	WeaponInventory.Reset();
+	Super::EndPlay(EndPlayReason);
 }
 
 void AMyProjectCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
@@ -301,8 +357,15 @@ void AMyProjectCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>&
 	DOREPLIFETIME(AMyProjectCharacter, bDied);
 }
 
+bool AMyProjectCharacter::CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack)
+{
+	FNetTelemetrySendScope SendScope(this, Function);
+	return Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
+}
+
 void AMyProjectCharacter::ServerDying_Implementation()
 {
+	UNetBandwidthTelemetrySubsystem::RecordServerRPC(this, GET_FUNCTION_NAME_CHECKED(AMyProjectCharacter, ServerDying));
 	Dying();
 }
 
@@ -7,6 +7,7 @@
 #include "MyProjectCharacter.generated.h"
 
 class AWeaponBase;
+class UMyProjectCharacterMovementComponent;
 class USpringArmComponent;
 class UCameraComponent;
 class UInputMappingContext;
@@ -77,6 +78,10 @@ class AMyProjectCharacter : public ACharacter
 	UPROPERTY(EditDefaultsOnly, Category = "Player")
 	TSubclassOf<AWeaponBase> StarerWeaponClass;
 
+	//Every weapon spawned for this character, reused when switching back
+	UPROPERTY(Transient)
+	TArray<AWeaponBase*> WeaponInventory;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Player", meta = (AllowPrivateAccess = "true"))
 	UHealthComponent* HealthComponent;
 	
@@ -93,12 +98,12 @@ class AMyProjectCharacter : public ACharacter
 	int32 CurWeaponIt{0};
 
 public:
-	AMyProjectCharacter();
+	AMyProjectCharacter(const FObjectInitializer& ObjectInitializer);
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	bool bIsSprinting;
 	
-	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Player")
+	UPROPERTY(ReplicatedUsing=OnRep_Died, BlueprintReadOnly, Category = "Player")
 	bool bDied;
 
 protected:
@@ -108,6 +113,10 @@ protected:
 
 	UFUNCTION(Reliable, Server, WithValidation)
 	void ServerDying();
+
+	//Ragdoll on clients and in replays, the server runs Dying
+	UFUNCTION()
+	void OnRep_Died();
 	
 	/** Called for movement input */
 	void Move(const FInputActionValue& Value);
@@ -134,6 +143,10 @@ protected:
 	void FirstWeapon();
 
 	void SecondWeapon();
+
+	AWeaponBase* FindOrSpawnWeapon(TSubclassOf<AWeaponBase> WeaponClass);
+
+	void EquipWeapon(TSubclassOf<AWeaponBase> WeaponClass);
 	
 	// To add mapping context
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
@@ -142,11 +155,22 @@ protected:
 
 	virtual void Tick(float DeltaTime);
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:
 	/** Returns CameraBoom subobject **/
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
 	/** Returns FollowCamera subobject **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const { return FollowCamera; }
+	/** Returns the equipped weapon **/
+	FORCEINLINE AWeaponBase* GetCurrentWeapon() const { return CurrentWeapon; }
+	/** Returns every weapon spawned for this character, equipped or not **/
+	FORCEINLINE const TArray<AWeaponBase*>& GetWeaponInventory() const { return WeaponInventory; }
+	/** Returns CharacterMovement as the project movement component **/
+	UMyProjectCharacterMovementComponent* GetMyCharacterMovement() const;
 
 	virtual FVector GetPawnViewLocation() const override;
+
+	//Names the RPC bunch for mp.Net.Telemetry
+	virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack) override;
 };
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombatSim.h"
+
+struct FSimCombatant
+{
+	FWeaponSimState Weapon;
+	FHealthSimState Health;
+	double NextActionTime = 0.0;
+	int32 Team = 0;
+};
+
+FSkirmishSimResult FCombatSkirmishSim::Run(const FCombatantSimConfig (&Teams)[2], int32 TeamSize, FRandomStream& Random, double TimeLimit)
+{
+	FSkirmishSimResult Result;
+	TeamSize = FMath::Max(TeamSize, 1);
+
+	TArray<FSimCombatant, TInlineAllocator<16>> Combatants;
+	Combatants.SetNum(TeamSize * 2);
+	int32 Alive[2] = {TeamSize, TeamSize};
+	for(int32 i = 0; i < Combatants.Num(); ++i)
+	{
+		FSimCombatant& Combatant = Combatants[i];
+		Combatant.Team = i < TeamSize ? 0 : 1;
+		const FCombatantSimConfig& Config = Teams[Combatant.Team];
+		Combatant.Weapon.Reset(Config.Weapon);
+		Combatant.Weapon.LastTimeFired = -Config.Weapon.GetTimeBetweenShots();
+		Combatant.Health.MaxHealth = Config.MaxHealth;
+		Combatant.Health.Health = Config.MaxHealth;
+		Combatant.NextActionTime = Config.ReactionTime * Random.FRandRange(0.5f, 1.5f);
+	}
+
+	TArray<int32, TInlineAllocator<8>> Targets;
+	double Now = 0.0;
+	while(Alive[0] > 0 && Alive[1] > 0)
+	{
+		//Next combatant to act
+		int32 ActorIndex = INDEX_NONE;
+		for(int32 i = 0; i < Combatants.Num(); ++i)
+		{
+			if(!Combatants[i].Health.IsDead() && (ActorIndex == INDEX_NONE || Combatants[i].NextActionTime < Combatants[ActorIndex].NextActionTime))
+			{
+				ActorIndex = i;
+			}
+		}
+		FSimCombatant& Actor = Combatants[ActorIndex];
+		Now = Actor.NextActionTime;
+		if(Now > TimeLimit)
+		{
+			Now = TimeLimit;
+			break;
+		}
+
+		const FCombatantSimConfig& Config = Teams[Actor.Team];
+		if(!Actor.Weapon.bCanFire)
+		{
+			Actor.Weapon.Reload(Config.Weapon);
+			Actor.NextActionTime = Now + FMath::Max<double>(Config.Weapon.ReloadTime, Actor.Weapon.GetFireDelay(Config.Weapon, Now));
+			continue;
+		}
+
+		Targets.Reset();
+		for(int32 i = 0; i < Combatants.Num(); ++i)
+		{
+			if(Combatants[i].Team != Actor.Team && !Combatants[i].Health.IsDead())
+			{
+				Targets.Add(i);
+			}
+		}
+		FSimCombatant& Target = Combatants[Targets[Random.RandHelper(Targets.Num())]];
+
+		++Result.ShotsFired[Actor.Team];
+		if(Random.FRand() < Config.Accuracy)
+		{
+			++Result.ShotsHit[Actor.Team];
+			Target.Health.ApplyDamage(Config.Weapon.BaseDamage);
+			if(Target.Health.IsDead())
+			{
+				--Alive[Target.Team];
+			}
+		}
+
+		const bool bEmptied = Actor.Weapon.ConsumeShot(Now);
+		Actor.NextActionTime = bEmptied ? Now : Now + Actor.Weapon.GetFireDelay(Config.Weapon, Now);
+	}
+
+	Result.Duration = Now;
+	if(Alive[0] > 0 && Alive[1] == 0)
+	{
+		Result.WinningTeam = 0;
+	}
+	else if(Alive[1] > 0 && Alive[0] == 0)
+	{
+		Result.WinningTeam = 1;
+	}
+	Result.Survivors = Result.WinningTeam == INDEX_NONE ? 0 : Alive[Result.WinningTeam];
+	return Result;
+}
@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Weapon and health rules without any UObject or UWorld dependency.
+ * AWeaponBase and UHealthComponent drive these with world time, the combat sim runner drives them with simulated time.
+ */
+
+struct FWeaponSimConfig
+{
+	float BaseDamage = 20.0f;
+
+	//Rounds per minute
+	float FireRate = 600.0f;
+
+	int32 MaxMagCapacity = 0;
+
+	//Only used by the simulation, the game reloads on input
+	float ReloadTime = 2.0f;
+
+	float GetTimeBetweenShots() const {return 60.0f / FMath::Max(FireRate, KINDA_SMALL_NUMBER);}
+};
+
+struct FWeaponSimState
+{
+	int32 Capacity = 0;
+
+	bool bCanFire = true;
+
+	double LastTimeFired = 0.0;
+
+	void Reset(const FWeaponSimConfig& Config)
+	{
+		Capacity = Config.MaxMagCapacity;
+		bCanFire = true;
+	}
+
+	//Time until the next shot is allowed by the fire cadence
+	double GetFireDelay(const FWeaponSimConfig& Config, double Now) const
+	{
+		return FMath::Max(LastTimeFired + Config.GetTimeBetweenShots() - Now, 0.0);
+	}
+
+	//Returns true when this shot emptied the magazine
+	bool ConsumeShot(double Now)
+	{
+		LastTimeFired = Now;
+		--Capacity;
+		if(Capacity <= 0)
+		{
+			bCanFire = false;
+			return true;
+		}
+		return false;
+	}
+
+	void Reload(const FWeaponSimConfig& Config)
+	{
+		Capacity = Config.MaxMagCapacity;
+		bCanFire = true;
+	}
+};
+
+struct FHealthSimState
+{
+	float Health = 100.0f;
+
+	float MaxHealth = 100.0f;
+
+	static float ApplyDelta(float Health, float Delta, float MaxHealth)
+	{
+		return FMath::Clamp(Health + Delta, 0.0f, MaxHealth);
+	}
+
+	//Returns the health actually removed
+	float ApplyDamage(float Damage)
+	{
+		if(Damage <= 0.0f)
+		{
+			return 0.0f;
+		}
+		const float OldHealth = Health;
+		Health = ApplyDelta(Health, -Damage, MaxHealth);
+		return OldHealth - Health;
+	}
+
+	bool IsDead() const {return Health <= 0.0f;}
+};
+
+struct FCombatantSimConfig
+{
+	FWeaponSimConfig Weapon;
+
+	float MaxHealth = 100.0f;
+
+	//Chance for a single shot to hit
+	float Accuracy = 0.5f;
+
+	//Delay before the first shot of an engagement
+	float ReactionTime = 0.25f;
+};
+
+struct FSkirmishSimResult
+{
+	//0 or 1, INDEX_NONE when both teams were still alive at the time limit
+	int32 WinningTeam = INDEX_NONE;
+
+	double Duration = 0.0;
+
+	int32 ShotsFired[2] = {0, 0};
+
+	int32 ShotsHit[2] = {0, 0};
+
+	int32 Survivors = 0;
+};
+
+/**
+ * Event driven skirmish between two teams of identical combatants, every combatant fires at a random living enemy.
+ * Runs in simulated time, a thousand skirmishes take milliseconds.
+ */
+struct MYPROJECT_API FCombatSkirmishSim
+{
+	static FSkirmishSimResult Run(const FCombatantSimConfig (&Teams)[2], int32 TeamSize, FRandomStream& Random, double TimeLimit = 300.0);
+};
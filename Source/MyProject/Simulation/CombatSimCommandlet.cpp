@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombatSimCommandlet.h"
+
+#include "CombatSim.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
+#include "../Weapons/WeaponBase.h"
+
+//Skirmishes per ParallelFor task, each batch has its own random stream so results do not depend on scheduling
+static constexpr int32 SkirmishesPerBatch = 256;
+
+struct FSkirmishBatchStats
+{
+	int32 Wins[2] = {0, 0};
+	int32 Draws = 0;
+	int64 ShotsFired[2] = {0, 0};
+	int64 ShotsHit[2] = {0, 0};
+	int64 Survivors = 0;
+	TArray<float> Durations;
+};
+
+static bool LoadWeaponConfig(const FString& Params, const TCHAR* Name, FWeaponSimConfig& OutConfig)
+{
+	FString ClassPath;
+	if(!FParse::Value(*Params, Name, ClassPath))
+	{
+		return false;
+	}
+	const UClass* WeaponClass = LoadClass<AWeaponBase>(nullptr, *ClassPath);
+	if(!WeaponClass)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not load weapon class %s"), *ClassPath);
+		return false;
+	}
+	OutConfig = WeaponClass->GetDefaultObject<AWeaponBase>()->GetSimConfig();
+	return true;
+}
+
+UCombatSimCommandlet::UCombatSimCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UCombatSimCommandlet::Main(const FString& Params)
+{
+	FCombatantSimConfig Teams[2];
+	if(!LoadWeaponConfig(Params, TEXT("WeaponA="), Teams[0].Weapon) || !LoadWeaponConfig(Params, TEXT("WeaponB="), Teams[1].Weapon))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Usage: -run=CombatSim -WeaponA=<class path> -WeaponB=<class path> [-Count=10000] [-TeamSize=1] [-AccuracyA=0.5] [-AccuracyB=0.5] [-Health=100] [-Seed=0] [-Csv=<out.csv>]"));
+		return 1;
+	}
+
+	int32 Count = 10000;
+	int32 TeamSize = 1;
+	int32 Seed = 0;
+	float Health = 100.0f;
+	FParse::Value(*Params, TEXT("Count="), Count);
+	FParse::Value(*Params, TEXT("TeamSize="), TeamSize);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("Health="), Health);
+	FParse::Value(*Params, TEXT("AccuracyA="), Teams[0].Accuracy);
+	FParse::Value(*Params, TEXT("AccuracyB="), Teams[1].Accuracy);
+	Teams[0].MaxHealth = Teams[1].MaxHealth = Health;
+
+	const int32 NumBatches = FMath::DivideAndRoundUp(FMath::Max(Count, 1), SkirmishesPerBatch);
+	TArray<FSkirmishBatchStats> Batches;
+	Batches.SetNum(NumBatches);
+
+	const double StartTime = FPlatformTime::Seconds();
+	ParallelFor(NumBatches, [&](int32 BatchIndex)
+	{
+		FSkirmishBatchStats& Stats = Batches[BatchIndex];
+		FRandomStream Random(Seed + BatchIndex);
+		const int32 NumInBatch = FMath::Min(SkirmishesPerBatch, Count - BatchIndex * SkirmishesPerBatch);
+		Stats.Durations.Reserve(NumInBatch);
+		for(int32 i = 0; i < NumInBatch; ++i)
+		{
+			const FSkirmishSimResult Result = FCombatSkirmishSim::Run(Teams, TeamSize, Random);
+			if(Result.WinningTeam == INDEX_NONE)
+			{
+				++Stats.Draws;
+			}
+			else
+			{
+				++Stats.Wins[Result.WinningTeam];
+				Stats.Durations.Add(static_cast<float>(Result.Duration));
+			}
+			for(int32 Team = 0; Team < 2; ++Team)
+			{
+				Stats.ShotsFired[Team] += Result.ShotsFired[Team];
+				Stats.ShotsHit[Team] += Result.ShotsHit[Team];
+			}
+			Stats.Survivors += Result.Survivors;
+		}
+	});
+	const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+
+	FSkirmishBatchStats Total;
+	for(FSkirmishBatchStats& Batch : Batches)
+	{
+		for(int32 Team = 0; Team < 2; ++Team)
+		{
+			Total.Wins[Team] += Batch.Wins[Team];
+			Total.ShotsFired[Team] += Batch.ShotsFired[Team];
+			Total.ShotsHit[Team] += Batch.ShotsHit[Team];
+		}
+		Total.Draws += Batch.Draws;
+		Total.Survivors += Batch.Survivors;
+		Total.Durations.Append(MoveTemp(Batch.Durations));
+	}
+	Total.Durations.Sort();
+
+	const auto Percentile = [&Total](float Fraction)
+	{
+		return Total.Durations.Num() > 0 ? Total.Durations[FMath::Min(FMath::FloorToInt(Fraction * Total.Durations.Num()), Total.Durations.Num() - 1)] : 0.0f;
+	};
+	const int32 Decided = Total.Wins[0] + Total.Wins[1];
+
+	UE_LOG(LogTemp, Display, TEXT("%d skirmishes of %dv%d in %.2fs"), Count, TeamSize, TeamSize, ElapsedSeconds);
+	for(int32 Team = 0; Team < 2; ++Team)
+	{
+		UE_LOG(LogTemp, Display, TEXT("  %s: win rate %.1f%%, accuracy %.1f%%, shots per skirmish %.1f"),
+			Team == 0 ? TEXT("A") : TEXT("B"), 100.0 * Total.Wins[Team] / FMath::Max(Count, 1),
+			100.0 * Total.ShotsHit[Team] / FMath::Max<int64>(Total.ShotsFired[Team], 1),
+			static_cast<double>(Total.ShotsFired[Team]) / FMath::Max(Count, 1));
+	}
+	UE_LOG(LogTemp, Display, TEXT("  Draws %d, time to kill p50 %.2fs p95 %.2fs, survivors per win %.2f"),
+		Total.Draws, Percentile(0.5f), Percentile(0.95f), static_cast<double>(Total.Survivors) / FMath::Max(Decided, 1));
+
+	FString CsvFilename;
+	if(FParse::Value(*Params, TEXT("Csv="), CsvFilename))
+	{
+		FString Csv = TEXT("Count,TeamSize,WinsA,WinsB,Draws,HitRateA,HitRateB,TTKp50,TTKp95\n");
+		Csv += FString::Printf(TEXT("%d,%d,%d,%d,%d,%.4f,%.4f,%.3f,%.3f\n"), Count, TeamSize, Total.Wins[0], Total.Wins[1], Total.Draws,
+			static_cast<double>(Total.ShotsHit[0]) / FMath::Max<int64>(Total.ShotsFired[0], 1),
+			static_cast<double>(Total.ShotsHit[1]) / FMath::Max<int64>(Total.ShotsFired[1], 1),
+			Percentile(0.5f), Percentile(0.95f));
+		FFileHelper::SaveStringToFile(Csv, *CsvFilename);
+	}
+	return 0;
+}
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CombatSimCommandlet.generated.h"
+
+/**
+ * Headless balance runner, plays simulated skirmishes between two weapon classes in parallel and reports aggregate stats.
+ * Usage: -run=CombatSim -WeaponA=<class path> -WeaponB=<class path> [-Count=10000] [-TeamSize=1]
+ *        [-AccuracyA=0.5] [-AccuracyB=0.5] [-Health=100] [-Seed=0] [-Csv=<out.csv>]
+ */
+UCLASS()
+class UCombatSimCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCombatSimCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
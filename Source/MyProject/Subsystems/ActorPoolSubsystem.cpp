@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../Subsystems/ActorPoolSubsystem.h"
+
+#include "../Subsystems/PooledActor.h"
+#include "Engine/World.h"
+
+static TAutoConsoleVariable<int32> CVarActorPoolMaxPerClass(
+	TEXT("mp.ActorPool.MaxPerClass"),
+	64,
+	TEXT("Free actors kept per class, released actors beyond this are destroyed."),
+	ECVF_Default);
+
+bool UActorPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+AActor* UActorPoolSubsystem::AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform, AActor* Owner,
+	APawn* Instigator)
+{
+	if(!ActorClass)
+	{
+		return nullptr;
+	}
+
+	if(ActorClass->ImplementsInterface(UPooledActor::StaticClass()))
+	{
+		if(FActorPoolBucket* Bucket = Buckets.Find(ActorClass))
+		{
+			while(Bucket->FreeActors.Num() > 0)
+			{
+				AActor* Actor = Bucket->FreeActors.Pop(false);
+				FreeActorSet.Remove(Actor);
+				if(!IsValid(Actor))
+				{
+					continue;
+				}
+				Actor->SetOwner(Owner);
+				Actor->SetInstigator(Instigator);
+				Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+				Actor->SetActorHiddenInGame(false);
+				Actor->SetActorEnableCollision(true);
+				Actor->SetActorTickEnabled(true);
+				IPooledActor::Execute_OnAcquiredFromPool(Actor);
+				return Actor;
+			}
+		}
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Owner = Owner;
+	SpawnParameters.Instigator = Instigator;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AActor* Actor = GetWorld()->SpawnActor<AActor>(ActorClass, Transform, SpawnParameters);
+	if(Actor && Actor->Implements<UPooledActor>())
+	{
+		IPooledActor::Execute_OnAcquiredFromPool(Actor);
+	}
+	return Actor;
+}
+
+void UActorPoolSubsystem::ReleaseActor(AActor* Actor)
+{
+	if(!IsValid(Actor))
+	{
+		return;
+	}
+
+	if(!Actor->Implements<UPooledActor>())
+	{
+		Actor->Destroy();
+		return;
+	}
+	//E.g. a projectile that hit something and then ran out its life span in the same frame
+	if(FreeActorSet.Contains(Actor))
+	{
+		return;
+	}
+	FActorPoolBucket& Bucket = Buckets.FindOrAdd(Actor->GetClass());
+	if(Bucket.FreeActors.Num() >= CVarActorPoolMaxPerClass.GetValueOnGameThread())
+	{
+		Actor->Destroy();
+		return;
+	}
+
+	FreeActorSet.Add(Actor);
+	IPooledActor::Execute_OnReleasedToPool(Actor);
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+	Bucket.FreeActors.Add(Actor);
+}
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ActorPoolSubsystem.generated.h"
+
+USTRUCT()
+struct FActorPoolBucket
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AActor*> FreeActors;
+};
+
+/**
+ * Recycles short lived actors such as projectiles so they do not churn through the garbage collector.
+ * Only classes implementing IPooledActor are pooled, anything else is spawned and destroyed as usual.
+ * Pooled actors call ReleaseActor instead of DestroyActor when they are done, releasing an actor twice is harmless.
+ * Actors spawned at runtime never join a GC cluster, clustering only covers actors loaded with a level, so pooling
+ * is what keeps them from being reachability tested and destroyed in bulk.
+ */
+UCLASS()
+class MYPROJECT_API UActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UFUNCTION(BlueprintCallable, Category = "Pool")
+	AActor* AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform, AActor* Owner, APawn* Instigator);
+
+	UFUNCTION(BlueprintCallable, Category = "Pool")
+	void ReleaseActor(AActor* Actor);
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	UPROPERTY()
+	TMap<UClass*, FActorPoolBucket> Buckets;
+
+	//Actors currently sitting in a bucket, a second release of the same actor is ignored
+	TSet<TObjectKey<AActor>> FreeActorSet;
+};
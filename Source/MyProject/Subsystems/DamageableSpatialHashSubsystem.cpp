@@ -0,0 +1,173 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../Subsystems/DamageableSpatialHashSubsystem.h"
+
+#include "../Components/HealthComponent.h"
+#include "Async/ParallelFor.h"
+#include "Kismet/GameplayStatics.h"
+
+static TAutoConsoleVariable<float> CVarSpatialHashCellSize(
+	TEXT("mp.SpatialHash.CellSize"),
+	1000.0f,
+	TEXT("Cell size of the damageable actor spatial hash, read when a world starts."),
+	ECVF_Default);
+
+//Below this the task overhead outweighs the traces
+static constexpr int32 MinParallelOcclusionTraces = 8;
+
+void UDamageableSpatialHashSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	CellSize = FMath::Max(CVarSpatialHashCellSize.GetValueOnGameThread(), 100.0f);
+	InvCellSize = 1.0f / CellSize;
+}
+
+bool UDamageableSpatialHashSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+FIntPoint UDamageableSpatialHashSubsystem::GetCell(const FVector& Location) const
+{
+	//Height is left out, levels are mostly flat and a column per cell keeps the map small
+	return FIntPoint(FMath::FloorToInt(Location.X * InvCellSize), FMath::FloorToInt(Location.Y * InvCellSize));
+}
+
+void UDamageableSpatialHashSubsystem::Register(UHealthComponent* HealthComp, const FVector& Location)
+{
+	if(!HealthComp || Entries.Contains(HealthComp))
+	{
+		return;
+	}
+	const FIntPoint Cell = GetCell(Location);
+	Entries.Add(HealthComp, {Location, Cell});
+	Cells.FindOrAdd(Cell).Add(HealthComp);
+}
+
+void UDamageableSpatialHashSubsystem::Unregister(UHealthComponent* HealthComp)
+{
+	FEntry Entry;
+	if(!Entries.RemoveAndCopyValue(HealthComp, Entry))
+	{
+		return;
+	}
+	if(TArray<UHealthComponent*>* CellComps = Cells.Find(Entry.Cell))
+	{
+		CellComps->RemoveSingleSwap(HealthComp, false);
+		if(CellComps->Num() == 0)
+		{
+			Cells.Remove(Entry.Cell);
+		}
+	}
+}
+
+void UDamageableSpatialHashSubsystem::UpdateLocation(UHealthComponent* HealthComp, const FVector& Location)
+{
+	FEntry* Entry = Entries.Find(HealthComp);
+	if(!Entry)
+	{
+		return;
+	}
+	Entry->Location = Location;
+
+	const FIntPoint NewCell = GetCell(Location);
+	if(NewCell == Entry->Cell)
+	{
+		return;
+	}
+	if(TArray<UHealthComponent*>* OldCellComps = Cells.Find(Entry->Cell))
+	{
+		OldCellComps->RemoveSingleSwap(HealthComp, false);
+		if(OldCellComps->Num() == 0)
+		{
+			Cells.Remove(Entry->Cell);
+		}
+	}
+	Cells.FindOrAdd(NewCell).Add(HealthComp);
+	Entry->Cell = NewCell;
+}
+
+void UDamageableSpatialHashSubsystem::QuerySphere(const FVector& Origin, float Radius,
+	TArray<UHealthComponent*>& OutHealthComps) const
+{
+	const FIntPoint MinCell = GetCell(Origin - FVector(Radius));
+	const FIntPoint MaxCell = GetCell(Origin + FVector(Radius));
+	const float RadiusSq = Radius * Radius;
+
+	for(int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for(int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			const TArray<UHealthComponent*>* CellComps = Cells.Find(FIntPoint(X, Y));
+			if(!CellComps)
+			{
+				continue;
+			}
+			for(UHealthComponent* HealthComp : *CellComps)
+			{
+				if(FVector::DistSquared(Entries.FindChecked(HealthComp).Location, Origin) <= RadiusSq)
+				{
+					OutHealthComps.Add(HealthComp);
+				}
+			}
+		}
+	}
+}
+
+int32 UDamageableSpatialHashSubsystem::ApplyRadialDamage(const FVector& Origin, float BaseDamage, float MinimumDamage,
+	float InnerRadius, float OuterRadius, TSubclassOf<UDamageType> DamageTypeClass, AActor* DamageCauser,
+	AController* InstigatedBy, const TArray<AActor*>& IgnoreActors, bool bCheckOcclusion, ECollisionChannel OcclusionChannel)
+{
+	TArray<UHealthComponent*, TInlineAllocator<32>> Candidates;
+	{
+		TArray<UHealthComponent*> Found;
+		QuerySphere(Origin, OuterRadius, Found);
+		for(UHealthComponent* HealthComp : Found)
+		{
+			if(!HealthComp->IsDead() && !IgnoreActors.Contains(HealthComp->GetOwner()))
+			{
+				Candidates.Add(HealthComp);
+			}
+		}
+	}
+	if(Candidates.Num() == 0)
+	{
+		return 0;
+	}
+
+	//Occlusion traces are read only scene queries, run them for all candidates at once across worker threads
+	if(bCheckOcclusion)
+	{
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(RadialDamageOcclusion), false, DamageCauser);
+		QueryParams.AddIgnoredActors(IgnoreActors);
+		const UWorld* World = GetWorld();
+		TArray<bool, TInlineAllocator<32>> Occluded;
+		Occluded.SetNumZeroed(Candidates.Num());
+		ParallelFor(Candidates.Num(), [&](int32 Index)
+		{
+			const AActor* Victim = Candidates[Index]->GetOwner();
+			FHitResult Hit;
+			Occluded[Index] = World->LineTraceSingleByChannel(Hit, Origin, Entries.FindChecked(Candidates[Index]).Location,
+				OcclusionChannel, QueryParams) && Hit.GetActor() != Victim;
+		}, Candidates.Num() < MinParallelOcclusionTraces ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+		for(int32 i = Candidates.Num() - 1; i >= 0; --i)
+		{
+			if(Occluded[i])
+			{
+				Candidates.RemoveAtSwap(i, 1, false);
+			}
+		}
+	}
+
+	const float FalloffRange = FMath::Max(OuterRadius - InnerRadius, KINDA_SMALL_NUMBER);
+	for(UHealthComponent* HealthComp : Candidates)
+	{
+		const float Distance = FVector::Dist(Entries.FindChecked(HealthComp).Location, Origin);
+		const float Alpha = FMath::Clamp((Distance - InnerRadius) / FalloffRange, 0.0f, 1.0f);
+		const float Damage = FMath::Lerp(BaseDamage, MinimumDamage, Alpha);
+		UGameplayStatics::ApplyDamage(HealthComp->GetOwner(), Damage, InstigatedBy, DamageCauser, DamageTypeClass);
+	}
+	return Candidates.Num();
+}
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DamageableSpatialHashSubsystem.generated.h"
+
+class UHealthComponent;
+class UDamageType;
+
+/**
+ * Server side uniform grid of every UHealthComponent owner, updated incrementally as owners move.
+ * Radial and area damage query this instead of physics overlaps, so their cost scales with nearby targets.
+ */
+UCLASS()
+class MYPROJECT_API UDamageableSpatialHashSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	void Register(UHealthComponent* HealthComp, const FVector& Location);
+
+	void Unregister(UHealthComponent* HealthComp);
+
+	void UpdateLocation(UHealthComponent* HealthComp, const FVector& Location);
+
+	//Appends every registered component whose owner is within Radius of Origin
+	void QuerySphere(const FVector& Origin, float Radius, TArray<UHealthComponent*>& OutHealthComps) const;
+
+	/**
+	 * Damage falls off from BaseDamage at InnerRadius to MinimumDamage at OuterRadius.
+	 * Occlusion is checked against OcclusionChannel after all candidates are gathered, the traces run in parallel.
+	 * Returns the number of damaged actors.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Damage", meta = (AutoCreateRefTerm = "IgnoreActors"))
+	int32 ApplyRadialDamage(const FVector& Origin, float BaseDamage, float MinimumDamage, float InnerRadius, float OuterRadius,
+		TSubclassOf<UDamageType> DamageTypeClass, AActor* DamageCauser, AController* InstigatedBy,
+		const TArray<AActor*>& IgnoreActors, bool bCheckOcclusion = true, ECollisionChannel OcclusionChannel = ECC_Visibility);
+
+	int32 GetNumRegistered() const {return Entries.Num();}
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+private:
+
+	struct FEntry
+	{
+		FVector Location;
+		FIntPoint Cell;
+	};
+
+	//Components unregister themselves in EndPlay, so raw pointers never outlive their owners here
+	TMap<UHealthComponent*, FEntry> Entries;
+
+	TMap<FIntPoint, TArray<UHealthComponent*>> Cells;
+
+	float CellSize = 1000.0f;
+
+	float InvCellSize = 0.001f;
+};
@@ -0,0 +1,195 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../Subsystems/GCHitchMonitorSubsystem.h"
+
+#include "UObject/UObjectGlobals.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGCHitch, Log, All);
+
+static TAutoConsoleVariable<float> CVarGCHitchBudgetMs(
+	TEXT("mp.GC.HitchBudgetMs"),
+	10.0f,
+	TEXT("Garbage collection pauses longer than this are logged as warnings."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarGCReportInterval(
+	TEXT("mp.GC.ReportInterval"),
+	60.0f,
+	TEXT("Seconds between garbage collection reports, read at startup. 0 disables the periodic report."),
+	ECVF_Default);
+
+//Purged objects per class counted by one thread, deletes come from the game thread and the async purge thread.
+//The counting thread holds Counts while it adds to it, the merge takes it only when it is not held
+struct FGCDeletedCountsSlot
+{
+	std::atomic<TMap<FName, int32>*> Counts{nullptr};
+};
+
+static FCriticalSection GGCDeletedSlotsLock;
+
+//Never freed, threads keep pointing at their slot
+static TArray<FGCDeletedCountsSlot*> GGCDeletedSlots;
+
+static thread_local FGCDeletedCountsSlot* GGCDeletedSlot = nullptr;
+
+static FAutoConsoleCommandWithOutputDevice GCReportCommand(
+	TEXT("mp.GC.Report"),
+	TEXT("Print garbage collection pauses and object churn since the last report."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+	{
+		if(UGCHitchMonitorSubsystem* Monitor = GEngine ? GEngine->GetEngineSubsystem<UGCHitchMonitorSubsystem>() : nullptr)
+		{
+			Monitor->Report(Ar);
+		}
+	}));
+
+void UGCHitchMonitorSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PreGCHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddUObject(this, &UGCHitchMonitorSubsystem::HandlePreGarbageCollect);
+	PostGCHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &UGCHitchMonitorSubsystem::HandlePostGarbageCollect);
+
+	GUObjectArray.AddUObjectCreateListener(this);
+	GUObjectArray.AddUObjectDeleteListener(this);
+	bListening = true;
+
+	ReportStartTime = FPlatformTime::Seconds();
+	const float ReportInterval = CVarGCReportInterval.GetValueOnGameThread();
+	if(ReportInterval > 0.0f)
+	{
+		ReportTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+			FTickerDelegate::CreateUObject(this, &UGCHitchMonitorSubsystem::HandleReportTicker), ReportInterval);
+	}
+}
+
+void UGCHitchMonitorSubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(ReportTickerHandle);
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGCHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGCHandle);
+	RemoveListeners();
+	Super::Deinitialize();
+}
+
+void UGCHitchMonitorSubsystem::RemoveListeners()
+{
+	if(bListening)
+	{
+		GUObjectArray.RemoveUObjectCreateListener(this);
+		GUObjectArray.RemoveUObjectDeleteListener(this);
+		bListening = false;
+	}
+}
+
+void UGCHitchMonitorSubsystem::OnUObjectArrayShutdown()
+{
+	RemoveListeners();
+}
+
+void UGCHitchMonitorSubsystem::NotifyUObjectCreated(const UObjectBase* Object, int32 Index)
+{
+	NumCreated.fetch_add(1, std::memory_order_relaxed);
+}
+
+void UGCHitchMonitorSubsystem::NotifyUObjectDeleted(const UObjectBase* Object, int32 Index)
+{
+	NumDeleted.fetch_add(1, std::memory_order_relaxed);
+	const UClass* Class = Object->GetClass();
+	if(!Class)
+	{
+		return;
+	}
+	//Runs inside the pause being measured, so no shared lock per object
+	if(!GGCDeletedSlot)
+	{
+		GGCDeletedSlot = new FGCDeletedCountsSlot();
+		FScopeLock Lock(&GGCDeletedSlotsLock);
+		GGCDeletedSlots.Add(GGCDeletedSlot);
+	}
+	TMap<FName, int32>* Counts = GGCDeletedSlot->Counts.exchange(nullptr, std::memory_order_acquire);
+	if(!Counts)
+	{
+		Counts = new TMap<FName, int32>();
+	}
+	++Counts->FindOrAdd(Class->GetFName());
+	GGCDeletedSlot->Counts.store(Counts, std::memory_order_release);
+}
+
+void UGCHitchMonitorSubsystem::MergeDeletedByClass()
+{
+	FScopeLock Lock(&GGCDeletedSlotsLock);
+	for(FGCDeletedCountsSlot* Slot : GGCDeletedSlots)
+	{
+		//A thread counting right now keeps its counts for the next merge
+		if(TMap<FName, int32>* Counts = Slot->Counts.exchange(nullptr, std::memory_order_acquire))
+		{
+			for(const TPair<FName, int32>& Pair : *Counts)
+			{
+				DeletedByClass.FindOrAdd(Pair.Key) += Pair.Value;
+			}
+			delete Counts;
+		}
+	}
+}
+
+void UGCHitchMonitorSubsystem::HandlePreGarbageCollect()
+{
+	GCStartTime = FPlatformTime::Seconds();
+}
+
+void UGCHitchMonitorSubsystem::HandlePostGarbageCollect()
+{
+	const double PauseMs = (FPlatformTime::Seconds() - GCStartTime) * 1000.0;
+	++NumCollections;
+	TotalPauseMs += PauseMs;
+	MaxPauseMs = FMath::Max(MaxPauseMs, PauseMs);
+
+	const float BudgetMs = CVarGCHitchBudgetMs.GetValueOnGameThread();
+	if(PauseMs > BudgetMs)
+	{
+		++NumOverBudget;
+		UE_LOG(LogGCHitch, Warning, TEXT("GC pause %.2fms over the %.2fms budget"), PauseMs, BudgetMs);
+	}
+	MergeDeletedByClass();
+}
+
+bool UGCHitchMonitorSubsystem::HandleReportTicker(float DeltaTime)
+{
+	Report(*GLog);
+	return true;
+}
+
+void UGCHitchMonitorSubsystem::Report(FOutputDevice& Ar)
+{
+	const double Now = FPlatformTime::Seconds();
+	const double Minutes = FMath::Max((Now - ReportStartTime) / 60.0, 1.0 / 60.0);
+
+	MergeDeletedByClass();
+	TArray<TPair<FName, int32>> TopClasses;
+	TopClasses.Reserve(DeletedByClass.Num());
+	for(const TPair<FName, int32>& Pair : DeletedByClass)
+	{
+		TopClasses.Add(Pair);
+	}
+	DeletedByClass.Reset();
+	TopClasses.Sort([](const TPair<FName, int32>& A, const TPair<FName, int32>& B) {return A.Value > B.Value;});
+
+	const int64 Created = NumCreated.exchange(0, std::memory_order_relaxed);
+	const int64 Deleted = NumDeleted.exchange(0, std::memory_order_relaxed);
+	Ar.Logf(TEXT("GC report over %.1f min: %d collections, max pause %.2fms, avg pause %.2fms, %d over budget"),
+		Minutes, NumCollections, MaxPauseMs, NumCollections > 0 ? TotalPauseMs / NumCollections : 0.0, NumOverBudget);
+	Ar.Logf(TEXT("  Objects created %.0f/min, purged %.0f/min, live %d"),
+		Created / Minutes, Deleted / Minutes, GUObjectArray.GetObjectArrayNumMinusAvailable());
+	for(int32 i = 0; i < FMath::Min(TopClasses.Num(), 10); ++i)
+	{
+		Ar.Logf(TEXT("  Purged %-40s %d"), *TopClasses[i].Key.ToString(), TopClasses[i].Value);
+	}
+
+	NumCollections = 0;
+	TotalPauseMs = 0.0;
+	MaxPauseMs = 0.0;
+	NumOverBudget = 0;
+	ReportStartTime = Now;
+}
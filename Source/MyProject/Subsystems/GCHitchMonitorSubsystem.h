@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "UObject/UObjectArray.h"
+#include <atomic>
+#include "GCHitchMonitorSubsystem.generated.h"
+
+/**
+ * Measures garbage collection pauses against a hitch budget and tracks UObject churn.
+ * Logs a report every mp.GC.ReportInterval seconds and on mp.GC.Report.
+ */
+UCLASS()
+class MYPROJECT_API UGCHitchMonitorSubsystem : public UEngineSubsystem,
+	public FUObjectArray::FUObjectCreateListener, public FUObjectArray::FUObjectDeleteListener
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	void Report(FOutputDevice& Ar);
+
+	//FUObjectCreateListener / FUObjectDeleteListener
+	virtual void NotifyUObjectCreated(const UObjectBase* Object, int32 Index) override;
+
+	virtual void NotifyUObjectDeleted(const UObjectBase* Object, int32 Index) override;
+
+	virtual void OnUObjectArrayShutdown() override;
+
+private:
+
+	void HandlePreGarbageCollect();
+
+	void HandlePostGarbageCollect();
+
+	bool HandleReportTicker(float DeltaTime);
+
+	void RemoveListeners();
+
+	double GCStartTime = 0.0;
+
+	//Since the last report
+	int32 NumCollections = 0;
+
+	double TotalPauseMs = 0.0;
+
+	double MaxPauseMs = 0.0;
+
+	int32 NumOverBudget = 0;
+
+	std::atomic<int64> NumCreated{0};
+
+	std::atomic<int64> NumDeleted{0};
+
+	//Merged from the per thread counts of NotifyUObjectDeleted after each collection, game thread only
+	TMap<FName, int32> DeletedByClass;
+
+	void MergeDeletedByClass();
+
+	double ReportStartTime = 0.0;
+
+	bool bListening = false;
+
+	FTSTicker::FDelegateHandle ReportTickerHandle;
+
+	FDelegateHandle PreGCHandle;
+
+	FDelegateHandle PostGCHandle;
+};
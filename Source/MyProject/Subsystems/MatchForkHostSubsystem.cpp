@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../Subsystems/MatchForkHostSubsystem.h"
+
+#include "Engine/Engine.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/Fork.h"
+#include "UObject/UObjectGlobals.h"
+#if PLATFORM_UNIX
+#include "Unix/UnixPlatformMemory.h"
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogMatchHost, Log, All);
+
+static FAutoConsoleCommandWithOutputDevice MatchHostMemoryCommand(
+	TEXT("mp.MatchHost.Memory"),
+	TEXT("Print this match process' memory use and the number of assets shared with the fork parent."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+	{
+		if(const UMatchForkHostSubsystem* MatchHost = GEngine ? GEngine->GetEngineSubsystem<UMatchForkHostSubsystem>() : nullptr)
+		{
+			MatchHost->ReportMemory(Ar);
+		}
+	}));
+
+void UMatchForkHostSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	if(FForkProcessHelper::IsForkRequested())
+	{
+		FCoreDelegates::OnParentBeginFork.AddUObject(this, &UMatchForkHostSubsystem::HandleParentBeginFork);
+		FCoreDelegates::OnPostFork.AddUObject(this, &UMatchForkHostSubsystem::HandlePostFork);
+	}
+}
+
+void UMatchForkHostSubsystem::Deinitialize()
+{
+	FCoreDelegates::OnParentBeginFork.RemoveAll(this);
+	FCoreDelegates::OnPostFork.RemoveAll(this);
+	Super::Deinitialize();
+}
+
+void UMatchForkHostSubsystem::HandleParentBeginFork()
+{
+	const double StartTime = FPlatformTime::Seconds();
+	for(const FSoftObjectPath& AssetPath : SharedMatchAssets)
+	{
+		if(UObject* Asset = AssetPath.TryLoad())
+		{
+			LoadedAssets.Add(Asset);
+		}
+		else
+		{
+			UE_LOG(LogMatchHost, Warning, TEXT("Shared match asset %s could not be loaded"), *AssetPath.ToString());
+		}
+	}
+
+	//Garbage left from loading would otherwise be collected in every child, dirtying shared pages
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+
+	UE_LOG(LogMatchHost, Display, TEXT("Preloaded %d shared match assets in %.2fs before forking"), LoadedAssets.Num(),
+		FPlatformTime::Seconds() - StartTime);
+	ReportMemory(*GLog);
+}
+
+void UMatchForkHostSubsystem::HandlePostFork(EForkProcessRole Role)
+{
+	if(Role == EForkProcessRole::Child)
+	{
+		UE_LOG(LogMatchHost, Display, TEXT("Match process %u forked"), FPlatformProcess::GetCurrentProcessId());
+		ReportMemory(*GLog);
+	}
+}
+
+void UMatchForkHostSubsystem::ReportMemory(FOutputDevice& Ar) const
+{
+	const FPlatformMemoryStats Stats = FPlatformMemory::GetStats();
+	const double ToMB = 1.0 / (1024.0 * 1024.0);
+	//RSS of a forked match includes every page it still shares with the parent, only private pages add up across matches
+	double PrivateMB = Stats.UsedPhysical * ToMB;
+	double SharedMB = 0.0;
+#if PLATFORM_UNIX
+	const FExtendedPlatformMemoryStats ExtendedStats = FUnixPlatformMemory::GetExtendedStats();
+	PrivateMB = (ExtendedStats.Private_Clean + ExtendedStats.Private_Dirty) * ToMB;
+	SharedMB = (ExtendedStats.Shared_Clean + ExtendedStats.Shared_Dirty) * ToMB;
+#endif
+	Ar.Logf(TEXT("Process %u (%s): private %.1f MB (%.1f matches per GB), shared %.1f MB, RSS %.1f MB, peak RSS %.1f MB, %d shared assets"),
+		FPlatformProcess::GetCurrentProcessId(), FForkProcessHelper::IsForkedChildProcess() ? TEXT("match") : TEXT("parent"),
+		PrivateMB, PrivateMB > 0.0 ? 1024.0 / PrivateMB : 0.0, SharedMB, Stats.UsedPhysical * ToMB, Stats.PeakUsedPhysical * ToMB,
+		LoadedAssets.Num());
+}
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/CoreDelegates.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "MatchForkHostSubsystem.generated.h"
+
+/**
+ * Packs several matches onto one Linux host with the engine's -WaitAndFork mode. The parent server loads the map and
+ * every SharedMatchAssets entry once, then forks a child per match; children share those pages copy-on-write and
+ * only pay for what their own match writes. Each child is a normal single-match server, so game modes, players and
+ * replication stay isolated per process. mp.MatchHost.Memory prints the memory private to the process, which is what
+ * adds up across matches, for matches-per-GB checks.
+ */
+UCLASS(config=Game)
+class MYPROJECT_API UMatchForkHostSubsystem : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	void ReportMemory(FOutputDevice& Ar) const;
+
+protected:
+
+	void HandleParentBeginFork();
+
+	void HandlePostFork(EForkProcessRole Role);
+
+	//Classes and assets loaded at runtime rather than by the map, e.g. spawned weapons, projectiles and FX
+	UPROPERTY(Config)
+	TArray<FSoftObjectPath> SharedMatchAssets;
+
+	//Held for the lifetime of the process so children never reload them
+	UPROPERTY(Transient)
+	TArray<UObject*> LoadedAssets;
+};
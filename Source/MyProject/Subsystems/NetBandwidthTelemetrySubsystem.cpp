@@ -0,0 +1,327 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../Subsystems/NetBandwidthTelemetrySubsystem.h"
+
+#include "../Subsystems/ServerBudgetGovernorSubsystem.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Fork.h"
+#include "Misc/Paths.h"
+
+static TAutoConsoleVariable<bool> CVarNetTelemetryEnabled(
+	TEXT("mp.Net.Telemetry.Enabled"),
+	true,
+	TEXT("Count the bunch bits sent and received per replicated property and RPC."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarNetTelemetryCsvInterval(
+	TEXT("mp.Net.Telemetry.CsvInterval"),
+	10.0f,
+	TEXT("Seconds between CSV rows on dedicated servers, 0 disables the CSV."),
+	ECVF_Default);
+
+static FNetTelemetryReceiveScope* GNetTelemetryReceiveScope = nullptr;
+
+static FNetTelemetrySendScope* GNetTelemetrySendScope = nullptr;
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice NetTelemetryDumpCommand(
+	TEXT("mp.Net.Telemetry.Dump"),
+	TEXT("Print bandwidth per replicated property and RPC for every connection."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if(const UNetBandwidthTelemetrySubsystem* Telemetry = World ? World->GetSubsystem<UNetBandwidthTelemetrySubsystem>() : nullptr)
+		{
+			Telemetry->Dump(Ar);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs NetTelemetryResetCommand(
+	TEXT("mp.Net.Telemetry.Reset"),
+	TEXT("Clear the bandwidth counters."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if(UNetBandwidthTelemetrySubsystem* Telemetry = World ? World->GetSubsystem<UNetBandwidthTelemetrySubsystem>() : nullptr)
+		{
+			Telemetry->Reset();
+		}
+	}));
+
+bool UNetBandwidthTelemetrySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UNetBandwidthTelemetrySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UNetBandwidthTelemetrySubsystem, STATGROUP_Tickables);
+}
+
+void UNetBandwidthTelemetrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	ResetTime = FPlatformTime::Seconds();
+	IntervalStartTime = ResetTime;
+
+	if(IsRunningDedicatedServer())
+	{
+		MakeCsvFilename();
+		if(FForkProcessHelper::IsForkRequested() && !FForkProcessHelper::IsForkedChildProcess())
+		{
+			FCoreDelegates::OnPostFork.AddUObject(this, &UNetBandwidthTelemetrySubsystem::HandlePostFork);
+		}
+	}
+}
+
+void UNetBandwidthTelemetrySubsystem::MakeCsvFilename()
+{
+	FString Suffix = FDateTime::Now().ToString();
+	if(FForkProcessHelper::IsForkedChildProcess())
+	{
+		Suffix += FString::Printf(TEXT("_%u"), FPlatformProcess::GetCurrentProcessId());
+	}
+	CsvFilename = FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("NetTelemetry") /
+		FString::Printf(TEXT("NetTelemetry_%s_%s.csv"), *GetWorld()->GetMapName(), *Suffix);
+}
+
+void UNetBandwidthTelemetrySubsystem::HandlePostFork(EForkProcessRole Role)
+{
+	//Forked matches start counting from zero into their own file, the parent keeps the binding for the next fork
+	if(Role == EForkProcessRole::Child)
+	{
+		FCoreDelegates::OnPostFork.RemoveAll(this);
+		Reset();
+		MakeCsvFilename();
+	}
+}
+
+void UNetBandwidthTelemetrySubsystem::Deinitialize()
+{
+	FCoreDelegates::OnPostFork.RemoveAll(this);
+	WriteCsv();
+	Super::Deinitialize();
+}
+
+FNetTelemetryReceiveScope::FNetTelemetryReceiveScope()
+	: Previous(GNetTelemetryReceiveScope)
+{
+	GNetTelemetryReceiveScope = this;
+}
+
+FNetTelemetryReceiveScope::~FNetTelemetryReceiveScope()
+{
+	GNetTelemetryReceiveScope = Previous;
+}
+
+FName FNetTelemetryReceiveScope::GetName() const
+{
+	if(Names.Num() <= 1)
+	{
+		return Names.Num() == 1 ? Names[0] : NAME_None;
+	}
+	FString Joined = Names[0].ToString();
+	for(int32 i = 1; i < Names.Num(); ++i)
+	{
+		Joined += TEXT("+") + Names[i].ToString();
+	}
+	return FName(*Joined);
+}
+
+FNetTelemetrySendScope::FNetTelemetrySendScope(const AActor* InActor, const UFunction* Function)
+	: Actor(InActor)
+	, Name(Function ? Function->GetFName() : NAME_None)
+	, Previous(GNetTelemetrySendScope)
+{
+	GNetTelemetrySendScope = this;
+}
+
+FNetTelemetrySendScope::~FNetTelemetrySendScope()
+{
+	GNetTelemetrySendScope = Previous;
+}
+
+FName FNetTelemetrySendScope::GetName(const AActor* Actor)
+{
+	return GNetTelemetrySendScope && GNetTelemetrySendScope->Actor == Actor ? GNetTelemetrySendScope->Name : NAME_None;
+}
+
+const TCHAR* FNetTelemetryKey::GetTrafficName() const
+{
+	switch(Traffic)
+	{
+	case ENetTelemetryTraffic::Replication:
+		return TEXT("Replication");
+	case ENetTelemetryTraffic::RPC:
+		return TEXT("RPC");
+	default:
+		return TEXT("ReceivedRPC");
+	}
+}
+
+UNetBandwidthTelemetrySubsystem* UNetBandwidthTelemetrySubsystem::GetForConnection(const UNetConnection* Connection)
+{
+	if(!Connection || !CVarNetTelemetryEnabled.GetValueOnGameThread())
+	{
+		return nullptr;
+	}
+	const UNetDriver* NetDriver = Connection->GetDriver();
+	const UWorld* World = NetDriver ? NetDriver->GetWorld() : nullptr;
+	//Only the game net driver, replay recording has its own connection
+	if(!World || World->GetNetDriver() != NetDriver)
+	{
+		return nullptr;
+	}
+	return World->GetSubsystem<UNetBandwidthTelemetrySubsystem>();
+}
+
+void UNetBandwidthTelemetrySubsystem::RecordServerRPC(const AActor* Actor, FName Name)
+{
+	if(GNetTelemetryReceiveScope && Actor)
+	{
+		GNetTelemetryReceiveScope->Names.AddUnique(Name);
+	}
+}
+
+const FString& UNetBandwidthTelemetrySubsystem::GetConnectionName(const UNetConnection* Connection)
+{
+	FString* Cached = ConnectionNames.Find(Connection);
+	if(Cached && (NamedConnections.Contains(Connection) || !Connection->PlayerController))
+	{
+		return *Cached;
+	}
+
+	FString Name = Connection->LowLevelGetRemoteAddress(true);
+	if(const APlayerController* PlayerController = Connection->PlayerController)
+	{
+		Name = FString::Printf(TEXT("%s (%s)"), *PlayerController->GetName(), *Name);
+		NamedConnections.Add(Connection);
+	}
+	if(Cached)
+	{
+		//Counted before login, carry those rows over to the player's name
+		for(TMap<FString, TMap<FNetTelemetryKey, FNetTelemetryCounter>>* Counters : {&Totals, &Interval})
+		{
+			TMap<FNetTelemetryKey, FNetTelemetryCounter> Previous;
+			if(Counters->RemoveAndCopyValue(*Cached, Previous))
+			{
+				TMap<FNetTelemetryKey, FNetTelemetryCounter>& Renamed = Counters->FindOrAdd(Name);
+				for(const TPair<FNetTelemetryKey, FNetTelemetryCounter>& Stat : Previous)
+				{
+					FNetTelemetryCounter& Counter = Renamed.FindOrAdd(Stat.Key);
+					Counter.Bits += Stat.Value.Bits;
+					Counter.Count += Stat.Value.Count;
+				}
+			}
+		}
+		*Cached = MoveTemp(Name);
+		return *Cached;
+	}
+	return ConnectionNames.Add(Connection, MoveTemp(Name));
+}
+
+void UNetBandwidthTelemetrySubsystem::Record(const UNetConnection* Connection, const FNetTelemetryKey& Key, int64 Bits)
+{
+	if(!Connection || Bits < 0)
+	{
+		return;
+	}
+	const FString& ConnectionName = GetConnectionName(Connection);
+
+	FNetTelemetryCounter& Total = Totals.FindOrAdd(ConnectionName).FindOrAdd(Key);
+	Total.Bits += Bits;
+	++Total.Count;
+
+	if(!CsvFilename.IsEmpty())
+	{
+		FNetTelemetryCounter& Current = Interval.FindOrAdd(ConnectionName).FindOrAdd(Key);
+		Current.Bits += Bits;
+		++Current.Count;
+	}
+}
+
+void UNetBandwidthTelemetrySubsystem::Tick(float DeltaTime)
+{
+	const float CsvInterval = CVarNetTelemetryCsvInterval.GetValueOnGameThread();
+	if(CsvFilename.IsEmpty() || CsvInterval <= 0.0f)
+	{
+		return;
+	}
+	if(FPlatformTime::Seconds() - IntervalStartTime >= CsvInterval && !bCsvWritePending)
+	{
+		//File IO on the game thread, waits while the server is over budget
+		bCsvWritePending = true;
+		UServerBudgetGovernorSubsystem::RunNonCritical(this, [WeakThis = TWeakObjectPtr<UNetBandwidthTelemetrySubsystem>(this)]()
+		{
+			if(UNetBandwidthTelemetrySubsystem* Telemetry = WeakThis.Get())
+			{
+				Telemetry->bCsvWritePending = false;
+				Telemetry->WriteCsv();
+			}
+		});
+	}
+}
+
+void UNetBandwidthTelemetrySubsystem::WriteCsv()
+{
+	const double Now = FPlatformTime::Seconds();
+	const double Elapsed = FMath::Max(Now - IntervalStartTime, 0.001);
+	IntervalStartTime = Now;
+	if(CsvFilename.IsEmpty() || Interval.Num() == 0)
+	{
+		return;
+	}
+
+	FString Rows;
+	if(!IFileManager::Get().FileExists(*CsvFilename))
+	{
+		Rows += TEXT("Time,Connection,Class,Traffic,Name,Count,Bytes,CountPerSec,BytesPerSec\n");
+	}
+	const FString Time = FDateTime::Now().ToString();
+	for(const TPair<FString, TMap<FNetTelemetryKey, FNetTelemetryCounter>>& Connection : Interval)
+	{
+		for(const TPair<FNetTelemetryKey, FNetTelemetryCounter>& Stat : Connection.Value)
+		{
+			const double Bytes = Stat.Value.Bits / 8.0;
+			Rows += FString::Printf(TEXT("%s,%s,%s,%s,%s,%d,%.0f,%.2f,%.2f\n"), *Time, *Connection.Key, *Stat.Key.Class.ToString(),
+				Stat.Key.GetTrafficName(), Stat.Key.Name.IsNone() ? TEXT("") : *Stat.Key.Name.ToString(),
+				Stat.Value.Count, Bytes, Stat.Value.Count / Elapsed, Bytes / Elapsed);
+		}
+	}
+	Interval.Reset();
+
+	FFileHelper::SaveStringToFile(Rows, *CsvFilename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM,
+		&IFileManager::Get(), FILEWRITE_Append);
+}
+
+void UNetBandwidthTelemetrySubsystem::Dump(FOutputDevice& Ar) const
+{
+	const double Elapsed = FMath::Max(FPlatformTime::Seconds() - ResetTime, 0.001);
+	Ar.Logf(TEXT("Net telemetry over %.1fs"), Elapsed);
+	for(const TPair<FString, TMap<FNetTelemetryKey, FNetTelemetryCounter>>& Connection : Totals)
+	{
+		Ar.Logf(TEXT("  %s"), *Connection.Key);
+		for(const TPair<FNetTelemetryKey, FNetTelemetryCounter>& Stat : Connection.Value)
+		{
+			const double Bytes = Stat.Value.Bits / 8.0;
+			const FString Name = FString::Printf(TEXT("%s %s %s"), *Stat.Key.Class.ToString(), Stat.Key.GetTrafficName(),
+				Stat.Key.Name.IsNone() ? TEXT("") : *Stat.Key.Name.ToString());
+			Ar.Logf(TEXT("    %-60s count %8d  bytes %10.0f  %8.2f/s  %10.2f B/s"), *Name,
+				Stat.Value.Count, Bytes, Stat.Value.Count / Elapsed, Bytes / Elapsed);
+		}
+	}
+}
+
+void UNetBandwidthTelemetrySubsystem::Reset()
+{
+	Totals.Reset();
+	Interval.Reset();
+	ConnectionNames.Reset();
+	NamedConnections.Reset();
+	ResetTime = FPlatformTime::Seconds();
+	IntervalStartTime = ResetTime;
+}
@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/CoreDelegates.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NetBandwidthTelemetrySubsystem.generated.h"
+
+struct FNetTelemetryCounter
+{
+	int64 Bits = 0;
+	int32 Count = 0;
+};
+
+enum class ENetTelemetryTraffic : uint8
+{
+	//Changed replicated properties, or with no name what else the update carried: handles, headers, queued RPCs
+	Replication,
+	//RPC bunches sent outside of actor replication
+	RPC,
+	//Bunches received from the remote side
+	ReceivedRPC
+};
+
+struct FNetTelemetryKey
+{
+	//Declaring class for properties, actor class otherwise
+	FName Class;
+
+	//Property or RPC name, None for what could not be attributed
+	FName Name;
+
+	ENetTelemetryTraffic Traffic;
+
+	bool operator==(const FNetTelemetryKey& Other) const
+	{
+		return Class == Other.Class && Name == Other.Name && Traffic == Other.Traffic;
+	}
+
+	friend uint32 GetTypeHash(const FNetTelemetryKey& Key)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Key.Class), GetTypeHash(Key.Name)), static_cast<uint32>(Key.Traffic));
+	}
+
+	const TCHAR* GetTrafficName() const;
+};
+
+//Collects the RPC names tagged through RecordServerRPC while a received bunch is processed, game thread only
+struct MYPROJECT_API FNetTelemetryReceiveScope
+{
+	FNetTelemetryReceiveScope();
+
+	~FNetTelemetryReceiveScope();
+
+	//Tagged names joined with '+', None when the bunch only carried untagged RPCs such as ServerMove
+	FName GetName() const;
+
+	TArray<FName, TInlineAllocator<4>> Names;
+
+private:
+
+	FNetTelemetryReceiveScope* Previous;
+};
+
+//Names the RPC bunch UNetTelemetryActorChannel sends while it is in scope, opened from CallRemoteFunction overrides
+struct MYPROJECT_API FNetTelemetrySendScope
+{
+	FNetTelemetrySendScope(const AActor* InActor, const UFunction* Function);
+
+	~FNetTelemetrySendScope();
+
+	//Name of the RPC Actor is sending, None when there is none
+	static FName GetName(const AActor* Actor);
+
+private:
+
+	const AActor* Actor;
+
+	FName Name;
+
+	FNetTelemetrySendScope* Previous;
+};
+
+/**
+ * Counters of bunch bits and send frequency per replicated property and RPC, broken down per connection.
+ * UNetTelemetryActorChannel reports every bunch as it is sent or received, so the figures follow what the replication
+ * layer actually wrote: changes coalesced into one update count once and initial replication is included.
+ * Properties of the actor and its replicated components that changed since the channel last sent them are measured with
+ * their NetSerialize, whatever the update carried on top is counted against the actor class with no name.
+ * Sent RPCs are named by FNetTelemetrySendScope, received ones by the RPCs their implementations tag through RecordServerRPC.
+ * Dump with mp.Net.Telemetry.Dump, dedicated servers also write a periodic CSV.
+ */
+UCLASS()
+class MYPROJECT_API UNetBandwidthTelemetrySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	//Subsystem of the connection's world when telemetry is enabled and Connection belongs to the game net driver
+	static UNetBandwidthTelemetrySubsystem* GetForConnection(const class UNetConnection* Connection);
+
+	//Tags the received bunch being processed with an RPC name, call from server RPC implementations
+	static void RecordServerRPC(const AActor* Actor, FName Name);
+
+	void Record(const class UNetConnection* Connection, const FNetTelemetryKey& Key, int64 Bits);
+
+	void Dump(FOutputDevice& Ar) const;
+
+	void Reset();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	const FString& GetConnectionName(const class UNetConnection* Connection);
+
+	void WriteCsv();
+
+	void MakeCsvFilename();
+
+	void HandlePostFork(EForkProcessRole Role);
+
+private:
+
+	//Connection description -> class, traffic and name -> counter, totals since the last reset
+	TMap<FString, TMap<FNetTelemetryKey, FNetTelemetryCounter>> Totals;
+
+	//Same layout, cleared every time the CSV is written
+	TMap<FString, TMap<FNetTelemetryKey, FNetTelemetryCounter>> Interval;
+
+	double ResetTime = 0.0;
+
+	double IntervalStartTime = 0.0;
+
+	FString CsvFilename;
+
+	bool bCsvWritePending = false;
+
+	//Named by address until the connection has a PlayerController, then renamed once
+	TMap<TObjectKey<UNetConnection>, FString> ConnectionNames;
+
+	TSet<TObjectKey<UNetConnection>> NamedConnections;
+};
@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../Subsystems/NetTelemetryActorChannel.h"
+
+#include "../Subsystems/NetBandwidthTelemetrySubsystem.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/PackageMapClient.h"
+#include "Net/DataBunch.h"
+#include "Net/UnrealNetwork.h"
+
+static TAutoConsoleVariable<bool> CVarNetTelemetryPerProperty(
+	TEXT("mp.Net.Telemetry.PerProperty"),
+	true,
+	TEXT("Break replication bunches down into the properties that changed, compares every replicated property on each send."),
+	ECVF_Default);
+
+static bool IsSentToConnection(ELifetimeCondition Condition, bool bNetOwner, bool bInitial)
+{
+	switch(Condition)
+	{
+	case COND_Never:
+		return false;
+	case COND_InitialOnly:
+		return bInitial;
+	case COND_OwnerOnly:
+	case COND_AutonomousOnly:
+		return bNetOwner;
+	case COND_SkipOwner:
+	case COND_SimulatedOnly:
+		return !bNetOwner;
+	case COND_InitialOrOwner:
+		return bInitial || bNetOwner;
+	default:
+		return true;
+	}
+}
+
+static int64 MeasurePropertyBits(const FProperty* Property, const void* Data, UNetConnection* Connection)
+{
+	//Structs without a native NetSerialize and arrays are written field by field by the rep layout
+	if(const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+	{
+		if(!(StructProperty->Struct->StructFlags & STRUCT_NetSerializeNative))
+		{
+			int64 Bits = 0;
+			for(TFieldIterator<FProperty> It(StructProperty->Struct); It; ++It)
+			{
+				if(It->HasAnyPropertyFlags(CPF_RepSkip))
+				{
+					continue;
+				}
+				for(int32 i = 0; i < It->ArrayDim; ++i)
+				{
+					Bits += MeasurePropertyBits(*It, It->ContainerPtrToValuePtr<void>(Data, i), Connection);
+				}
+			}
+			return Bits;
+		}
+	}
+	if(const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+	{
+		FScriptArrayHelper Array(ArrayProperty, Data);
+		//Element count
+		int64 Bits = 16;
+		for(int32 i = 0; i < Array.Num(); ++i)
+		{
+			Bits += MeasurePropertyBits(ArrayProperty->Inner, Array.GetRawPtr(i), Connection);
+		}
+		return Bits;
+	}
+
+	FNetBitWriter Writer(Connection->PackageMap, 256);
+	if(const FObjectPropertyBase* ObjectProperty = CastField<FObjectPropertyBase>(Property))
+	{
+		//A mapped object is written as its NetGUID, going through the package map here could export it
+		FNetworkGUID NetGUID = Connection->Driver->GuidCache->GetNetGUID(ObjectProperty->GetObjectPropertyValue(Data));
+		Writer << NetGUID;
+	}
+	else
+	{
+		Property->NetSerializeItem(Writer, Connection->PackageMap, const_cast<void*>(Data));
+	}
+	return Writer.GetNumBits();
+}
+
+FNetTelemetryPropertyShadow::FNetTelemetryPropertyShadow(const UObject* Object)
+{
+	const UClass* Class = Object->GetClass();
+	TArray<FLifetimeProperty> LifetimeProperties;
+	Object->GetLifetimeReplicatedProps(LifetimeProperties);
+	for(const FLifetimeProperty& LifetimeProperty : LifetimeProperties)
+	{
+		if(!Class->ClassReps.IsValidIndex(LifetimeProperty.RepIndex))
+		{
+			continue;
+		}
+		const FRepRecord& Record = Class->ClassReps[LifetimeProperty.RepIndex];
+		void* Data = FMemory::Malloc(Record.Property->ElementSize, Record.Property->GetMinAlignment());
+		Record.Property->InitializeValue(Data);
+		Values.Add({Record.Property, Record.Index, LifetimeProperty.Condition, Data});
+	}
+}
+
+FNetTelemetryPropertyShadow::~FNetTelemetryPropertyShadow()
+{
+	for(const FValue& Value : Values)
+	{
+		Value.Property->DestroyValue(Value.Data);
+		FMemory::Free(Value.Data);
+	}
+}
+
+FPacketIdRange UNetTelemetryActorChannel::SendBunch(FOutBunch* Bunch, bool Merge)
+{
+	UNetBandwidthTelemetrySubsystem* Telemetry = Bunch && Actor ? UNetBandwidthTelemetrySubsystem::GetForConnection(Connection) : nullptr;
+	//Size before the bunch is merged or split into packets, the header overhead is the connection's
+	if(Telemetry && !Bunch->IsError())
+	{
+		if(bIsReplicatingActor)
+		{
+			RecordReplication(*Telemetry, Bunch->GetNumBits());
+		}
+		else
+		{
+			Telemetry->Record(Connection, {Actor->GetClass()->GetFName(), FNetTelemetrySendScope::GetName(Actor), ENetTelemetryTraffic::RPC},
+				Bunch->GetNumBits());
+		}
+	}
+	return Super::SendBunch(Bunch, Merge);
+}
+
+void UNetTelemetryActorChannel::RecordReplication(UNetBandwidthTelemetrySubsystem& Telemetry, int64 BunchBits)
+{
+	int64 PropertyBits = 0;
+	if(CVarNetTelemetryPerProperty.GetValueOnGameThread())
+	{
+		const bool bNetOwner = Actor->GetNetConnection() == Connection;
+		PropertyBits += RecordChangedProperties(Telemetry, Actor, bNetOwner);
+		Actor->ForEachComponent(false, [this, &Telemetry, &PropertyBits, bNetOwner](UActorComponent* Component)
+		{
+			if(Component->GetIsReplicated())
+			{
+				PropertyBits += RecordChangedProperties(Telemetry, Component, bNetOwner);
+			}
+		});
+	}
+	//Handles, headers, subobject creation and queued RPCs
+	Telemetry.Record(Connection, {Actor->GetClass()->GetFName(), NAME_None, ENetTelemetryTraffic::Replication},
+		FMath::Max<int64>(BunchBits - PropertyBits, 0));
+}
+
+int64 UNetTelemetryActorChannel::RecordChangedProperties(UNetBandwidthTelemetrySubsystem& Telemetry, const UObject* Object, bool bNetOwner)
+{
+	TUniquePtr<FNetTelemetryPropertyShadow>& Shadow = Shadows.FindOrAdd(Object);
+	if(!Shadow)
+	{
+		Shadow = MakeUnique<FNetTelemetryPropertyShadow>(Object);
+	}
+
+	int64 Bits = 0;
+	for(const FNetTelemetryPropertyShadow::FValue& Value : Shadow->Values)
+	{
+		if(!IsSentToConnection(Value.Condition, bNetOwner, !Shadow->bSent))
+		{
+			continue;
+		}
+		const void* Data = Value.Property->ContainerPtrToValuePtr<void>(Object, Value.Index);
+		if(Shadow->bSent && Value.Property->Identical(Data, Value.Data))
+		{
+			continue;
+		}
+		const int64 ValueBits = MeasurePropertyBits(Value.Property, Data, Connection);
+		Telemetry.Record(Connection, {Value.Property->GetOwnerClass()->GetFName(), Value.Property->GetFName(),
+			ENetTelemetryTraffic::Replication}, ValueBits);
+		Value.Property->CopySingleValue(Value.Data, Data);
+		Bits += ValueBits;
+	}
+	Shadow->bSent = true;
+	return Bits;
+}
+
+void UNetTelemetryActorChannel::ReceivedBunch(FInBunch& Bunch)
+{
+	const int64 Bits = Bunch.GetNumBits();
+	FNetTelemetryReceiveScope ReceiveScope;
+	Super::ReceivedBunch(Bunch);
+
+	//Actor may only exist after the open bunch was processed, or be gone after a close
+	UNetBandwidthTelemetrySubsystem* Telemetry = Actor ? UNetBandwidthTelemetrySubsystem::GetForConnection(Connection) : nullptr;
+	if(Telemetry)
+	{
+		Telemetry->Record(Connection, {Actor->GetClass()->GetFName(), ReceiveScope.GetName(), ENetTelemetryTraffic::ReceivedRPC}, Bits);
+	}
+}
+
+bool UNetTelemetryActorChannel::CleanUp(const bool bForDestroy, EChannelCloseReason CloseReason)
+{
+	Shadows.Reset();
+	return Super::CleanUp(bForDestroy, CloseReason);
+}
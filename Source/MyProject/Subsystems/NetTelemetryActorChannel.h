@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/ActorChannel.h"
+#include "UObject/CoreNetTypes.h"
+#include "NetTelemetryActorChannel.generated.h"
+
+class UNetBandwidthTelemetrySubsystem;
+
+//Copy of the replicated properties of one object as this channel last sent them
+struct FNetTelemetryPropertyShadow
+{
+	struct FValue
+	{
+		const FProperty* Property;
+
+		//Element of a static array property
+		int32 Index;
+
+		ELifetimeCondition Condition;
+
+		void* Data;
+	};
+
+	TArray<FValue> Values;
+
+	bool bSent = false;
+
+	FNetTelemetryPropertyShadow(const UObject* Object);
+
+	~FNetTelemetryPropertyShadow();
+};
+
+/**
+ * Actor channel that reports the size of every bunch it sends or receives to UNetBandwidthTelemetrySubsystem.
+ * Replication bunches are split into the properties of the actor and its replicated components that changed since
+ * the last send, each measured with its own NetSerialize, and the rest of the bunch.
+ * Registered in place of the engine actor channel through NetDriver ChannelDefinitions in DefaultEngine.ini.
+ */
+UCLASS(Transient)
+class MYPROJECT_API UNetTelemetryActorChannel : public UActorChannel
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual FPacketIdRange SendBunch(FOutBunch* Bunch, bool Merge) override;
+
+	virtual void ReceivedBunch(FInBunch& Bunch) override;
+
+protected:
+
+	virtual bool CleanUp(const bool bForDestroy, EChannelCloseReason CloseReason) override;
+
+	void RecordReplication(UNetBandwidthTelemetrySubsystem& Telemetry, int64 BunchBits);
+
+	//Records the properties of Object that changed since the last send, returns their bits
+	int64 RecordChangedProperties(UNetBandwidthTelemetrySubsystem& Telemetry, const UObject* Object, bool bNetOwner);
+
+private:
+
+	TMap<TObjectKey<UObject>, TUniquePtr<FNetTelemetryPropertyShadow>> Shadows;
+};
@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "PooledActor.generated.h"
+
+UINTERFACE(MinimalAPI, BlueprintType)
+class UPooledActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+//Actors implementing this are recycled by UActorPoolSubsystem instead of being spawned and destroyed
+class MYPROJECT_API IPooledActor
+{
+	GENERATED_BODY()
+
+public:
+
+	//Reset per use state here, the actor is already moved, shown and has collision again
+	UFUNCTION(BlueprintNativeEvent, Category = "Pool")
+	void OnAcquiredFromPool();
+
+	UFUNCTION(BlueprintNativeEvent, Category = "Pool")
+	void OnReleasedToPool();
+};
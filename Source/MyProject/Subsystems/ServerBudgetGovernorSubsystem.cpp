@@ -0,0 +1,277 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../Subsystems/ServerBudgetGovernorSubsystem.h"
+
+#include "../MyProjectCharacter.h"
+#include "../Weapons/WeaponBase.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogServerGovernor, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("ServerGovernor"), STATGROUP_ServerGovernor, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Load tier"), STAT_GovernorTier, STATGROUP_ServerGovernor);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Smoothed game thread ms"), STAT_GovernorFrameMs, STATGROUP_ServerGovernor);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Throttled actors"), STAT_GovernorThrottled, STATGROUP_ServerGovernor);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Deferred work"), STAT_GovernorDeferred, STATGROUP_ServerGovernor);
+
+CSV_DEFINE_CATEGORY(ServerGovernor, true);
+
+static TAutoConsoleVariable<float> CVarGovernorBudgetMs(
+	TEXT("mp.Governor.BudgetMs"),
+	33.3f,
+	TEXT("Game thread budget per server frame in milliseconds, 0 disables the governor."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarGovernorFarDistance(
+	TEXT("mp.Governor.FarDistance"),
+	5000.0f,
+	TEXT("Pawns further than this from every player get a lower net update rate from the ReduceFarNetRate tier on."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarGovernorMaxDeferredWork(
+	TEXT("mp.Governor.MaxDeferredWork"),
+	256,
+	TEXT("Deferred work items kept while the server is over budget, the oldest ones that may expire are dropped beyond it."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarGovernorCosmeticMaxAge(
+	TEXT("mp.Governor.CosmeticMaxAge"),
+	0.2f,
+	TEXT("Seconds cosmetic work may wait before it is dropped instead of being played late."),
+	ECVF_Default);
+
+//Frame time has to stay over the budget this long before stepping up, and under the lower threshold before stepping down
+static constexpr float EscalateDelay = 1.0f;
+static constexpr float RelaxDelay = 3.0f;
+static constexpr float RelaxThreshold = 0.8f;
+static constexpr float FarNetRateScale = 0.25f;
+static constexpr int32 DeferredWorkPerFrame = 4;
+
+bool UServerBudgetGovernorSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UServerBudgetGovernorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UServerBudgetGovernorSubsystem, STATGROUP_Tickables);
+}
+
+void UServerBudgetGovernorSubsystem::Deinitialize()
+{
+	//Work that never ran is dropped with the world
+	DeferredWork.Reset();
+	ThrottledActors.Reset();
+	Super::Deinitialize();
+}
+
+bool UServerBudgetGovernorSubsystem::ShouldSkipCosmetics(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const UServerBudgetGovernorSubsystem* Governor = World ? World->GetSubsystem<UServerBudgetGovernorSubsystem>() : nullptr;
+	return Governor && Governor->Tier >= EServerLoadTier::SkipCosmetics;
+}
+
+void UServerBudgetGovernorSubsystem::RunNonCritical(const UObject* WorldContextObject, TFunction<void()>&& Work, float MaxAge)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	UServerBudgetGovernorSubsystem* Governor = World ? World->GetSubsystem<UServerBudgetGovernorSubsystem>() : nullptr;
+	if(Governor && Governor->ShouldDeferNonCritical())
+	{
+		Governor->DeferredWork.Add({MoveTemp(Work), MaxAge > 0.0f ? World->GetTimeSeconds() + MaxAge : 0.0});
+		Governor->TrimDeferredWork();
+		return;
+	}
+	Work();
+}
+
+void UServerBudgetGovernorSubsystem::RunCosmetic(const UObject* WorldContextObject, TFunction<void()>&& Work)
+{
+	if(!ShouldSkipCosmetics(WorldContextObject))
+	{
+		RunNonCritical(WorldContextObject, MoveTemp(Work), CVarGovernorCosmeticMaxAge.GetValueOnGameThread());
+	}
+}
+
+void UServerBudgetGovernorSubsystem::TrimDeferredWork()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	int32 NumToDrop = DeferredWork.Num() - FMath::Max(CVarGovernorMaxDeferredWork.GetValueOnGameThread(), 0);
+	DeferredWork.RemoveAll([Now, &NumToDrop](const FDeferredWork& Deferred)
+	{
+		if(Deferred.ExpireTime <= 0.0)
+		{
+			return false;
+		}
+		//Oldest first, the queue is in submission order
+		if(Deferred.ExpireTime < Now || NumToDrop > 0)
+		{
+			--NumToDrop;
+			return true;
+		}
+		return false;
+	});
+}
+
+void UServerBudgetGovernorSubsystem::Tick(float DeltaTime)
+{
+	const ENetMode NetMode = GetWorld()->GetNetMode();
+	const float BudgetMs = CVarGovernorBudgetMs.GetValueOnGameThread();
+	if((NetMode != NM_DedicatedServer && NetMode != NM_ListenServer) || BudgetMs <= 0.0f)
+	{
+		return;
+	}
+
+	//Game thread time of the previous frame, which is what the budget is about
+	const float FrameMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+	SmoothedFrameMs = SmoothedFrameMs > 0.0f ? FMath::Lerp(SmoothedFrameMs, FrameMs, 0.1f) : FrameMs;
+
+	if(SmoothedFrameMs > BudgetMs)
+	{
+		OverBudgetTime += DeltaTime;
+		UnderBudgetTime = 0.0f;
+		if(OverBudgetTime >= EscalateDelay && Tier < EServerLoadTier::DeferNonCritical)
+		{
+			SetTier(static_cast<EServerLoadTier>(static_cast<uint8>(Tier) + 1), SmoothedFrameMs);
+			OverBudgetTime = 0.0f;
+		}
+	}
+	else if(SmoothedFrameMs < BudgetMs * RelaxThreshold)
+	{
+		UnderBudgetTime += DeltaTime;
+		OverBudgetTime = 0.0f;
+		if(UnderBudgetTime >= RelaxDelay && Tier > EServerLoadTier::Normal)
+		{
+			SetTier(static_cast<EServerLoadTier>(static_cast<uint8>(Tier) - 1), SmoothedFrameMs);
+			UnderBudgetTime = 0.0f;
+		}
+	}
+	else
+	{
+		OverBudgetTime = 0.0f;
+		UnderBudgetTime = 0.0f;
+	}
+
+	if(Tier >= EServerLoadTier::ReduceFarNetRate)
+	{
+		NetRateUpdateTime -= DeltaTime;
+		if(NetRateUpdateTime <= 0.0f)
+		{
+			UpdateFarNetRates();
+			NetRateUpdateTime = 0.5f;
+		}
+	}
+
+	if(DeferredWork.Num() > 0)
+	{
+		TrimDeferredWork();
+	}
+	if(!ShouldDeferNonCritical() && DeferredWork.Num() > 0)
+	{
+		//Moved out first, work is allowed to queue more work
+		const int32 NumToRun = FMath::Min(DeferredWork.Num(), DeferredWorkPerFrame);
+		TArray<TFunction<void()>, TInlineAllocator<DeferredWorkPerFrame>> Batch;
+		for(int32 i = 0; i < NumToRun; ++i)
+		{
+			Batch.Add(MoveTemp(DeferredWork[i].Work));
+		}
+		DeferredWork.RemoveAt(0, NumToRun, false);
+		for(TFunction<void()>& Work : Batch)
+		{
+			Work();
+		}
+	}
+
+	SET_DWORD_STAT(STAT_GovernorTier, static_cast<uint32>(Tier));
+	SET_FLOAT_STAT(STAT_GovernorFrameMs, SmoothedFrameMs);
+	SET_DWORD_STAT(STAT_GovernorThrottled, ThrottledActors.Num());
+	SET_DWORD_STAT(STAT_GovernorDeferred, DeferredWork.Num());
+	CSV_CUSTOM_STAT(ServerGovernor, Tier, static_cast<int32>(Tier), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ServerGovernor, SmoothedFrameMs, SmoothedFrameMs, ECsvCustomStatOp::Set);
+}
+
+void UServerBudgetGovernorSubsystem::SetTier(EServerLoadTier NewTier, float FrameMs)
+{
+	UE_LOG(LogServerGovernor, Log, TEXT("Load tier %s -> %s (game thread %.2fms, budget %.2fms)"),
+		*UEnum::GetValueAsString(Tier), *UEnum::GetValueAsString(NewTier), FrameMs, CVarGovernorBudgetMs.GetValueOnGameThread());
+	Tier = NewTier;
+	if(Tier < EServerLoadTier::ReduceFarNetRate)
+	{
+		RestoreNetRates();
+	}
+}
+
+void UServerBudgetGovernorSubsystem::UpdateFarNetRates()
+{
+	for(auto It = ThrottledActors.CreateIterator(); It; ++It)
+	{
+		if(!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	TArray<FVector, TInlineAllocator<64>> ViewLocations;
+	for(FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if(const APawn* ViewPawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+		{
+			ViewLocations.Add(ViewPawn->GetActorLocation());
+		}
+	}
+
+	const float FarDistanceSq = FMath::Square(CVarGovernorFarDistance.GetValueOnGameThread());
+	for(TActorIterator<AMyProjectCharacter> It(GetWorld()); It; ++It)
+	{
+		AMyProjectCharacter* Character = *It;
+		const FVector Location = Character->GetActorLocation();
+		int32 NumNear = 0;
+		for(const FVector& ViewLocation : ViewLocations)
+		{
+			if(FVector::DistSquared(ViewLocation, Location) < FarDistanceSq)
+			{
+				++NumNear;
+			}
+		}
+		//The character's own player is always near, it only counts as far when nobody else is close
+		const bool bFar = NumNear <= (Character->IsPlayerControlled() ? 1 : 0);
+
+		//Every weapon the character carries, so switching weapons neither escapes nor keeps the throttle
+		TArray<AActor*, TInlineAllocator<8>> Actors;
+		Actors.Add(Character);
+		Actors.Append(Character->GetWeaponInventory());
+		for(AActor* Actor : Actors)
+		{
+			if(!Actor)
+			{
+				continue;
+			}
+			const float* OriginalRate = ThrottledActors.Find(Actor);
+			if(bFar && !OriginalRate)
+			{
+				ThrottledActors.Add(Actor, Actor->NetUpdateFrequency);
+				Actor->NetUpdateFrequency = FMath::Max(Actor->NetUpdateFrequency * FarNetRateScale, Actor->MinNetUpdateFrequency);
+			}
+			else if(!bFar && OriginalRate)
+			{
+				Actor->NetUpdateFrequency = *OriginalRate;
+				ThrottledActors.Remove(Actor);
+			}
+		}
+	}
+}
+
+void UServerBudgetGovernorSubsystem::RestoreNetRates()
+{
+	for(const TPair<TWeakObjectPtr<AActor>, float>& Pair : ThrottledActors)
+	{
+		if(AActor* Actor = Pair.Key.Get())
+		{
+			Actor->NetUpdateFrequency = Pair.Value;
+		}
+	}
+	ThrottledActors.Reset();
+}
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ServerBudgetGovernorSubsystem.generated.h"
+
+UENUM(BlueprintType)
+enum class EServerLoadTier : uint8
+{
+	//Everything at full fidelity
+	Normal,
+	//Distant pawns and their weapons replicate less often
+	ReduceFarNetRate,
+	//Ragdolls, effects and other cosmetic server work is skipped
+	SkipCosmetics,
+	//Non-critical spawns and work are queued until load drops
+	DeferNonCritical
+};
+
+/**
+ * Compares the server's game thread time against mp.Governor.BudgetMs and steps through EServerLoadTier.
+ * Hit registration, damage and movement are never degraded; gameplay code asks the governor before doing optional work.
+ */
+UCLASS()
+class MYPROJECT_API UServerBudgetGovernorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UFUNCTION(BlueprintCallable, Category = "Governor")
+	EServerLoadTier GetTier() const {return Tier;}
+
+	UFUNCTION(BlueprintCallable, Category = "Governor")
+	bool ShouldDeferNonCritical() const {return Tier >= EServerLoadTier::DeferNonCritical;}
+
+	static bool ShouldSkipCosmetics(const UObject* WorldContextObject);
+
+	//Runs Work right away unless the tier defers it, deferred work is drained a few items per frame.
+	//Work with a MaxAge is dropped once it waited longer than that or the queue is over mp.Governor.MaxDeferredWork
+	static void RunNonCritical(const UObject* WorldContextObject, TFunction<void()>&& Work, float MaxAge = 0.0f);
+
+	//Effects and other work only for show: dropped from the SkipCosmetics tier on, never run late
+	static void RunCosmetic(const UObject* WorldContextObject, TFunction<void()>&& Work);
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual void Deinitialize() override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	void SetTier(EServerLoadTier NewTier, float FrameMs);
+
+	void UpdateFarNetRates();
+
+	void RestoreNetRates();
+
+private:
+
+	EServerLoadTier Tier = EServerLoadTier::Normal;
+
+	float SmoothedFrameMs = 0.0f;
+
+	//How long the frame time has been over or under the thresholds
+	float OverBudgetTime = 0.0f;
+
+	float UnderBudgetTime = 0.0f;
+
+	float NetRateUpdateTime = 0.0f;
+
+	//Net update frequencies before they were lowered
+	TMap<TWeakObjectPtr<AActor>, float> ThrottledActors;
+
+	struct FDeferredWork
+	{
+		TFunction<void()> Work;
+
+		//World time after which the work is dropped, 0 keeps it until it runs
+		double ExpireTime;
+	};
+
+	TArray<FDeferredWork> DeferredWork;
+
+	void TrimDeferredWork();
+};
@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../Subsystems/StatusEffectSubsystem.h"
+
+#include "../Components/HealthComponent.h"
+#include "GameFramework/DamageType.h"
+
+static TAutoConsoleVariable<float> CVarStatusEffectStep(
+	TEXT("mp.StatusEffects.StepInterval"),
+	0.25f,
+	TEXT("Seconds between status effect steps on the server."),
+	ECVF_Default);
+
+bool UStatusEffectSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UStatusEffectSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStatusEffectSubsystem, STATGROUP_Tickables);
+}
+
+int32 UStatusEffectSubsystem::ApplyStatusEffect(AActor* Target, const FStatusEffectSpec& Spec, AController* InstigatedBy,
+	AActor* DamageCauser)
+{
+	if(!Target || !Target->HasAuthority() || Spec.Duration <= 0.0f)
+	{
+		return 0;
+	}
+	UHealthComponent* HealthComp = Target->FindComponentByClass<UHealthComponent>();
+	if(!HealthComp || HealthComp->IsDead())
+	{
+		return 0;
+	}
+
+	FActiveStatusEffect& Effect = Effects.AddDefaulted_GetRef();
+	Effect.Target = HealthComp;
+	Effect.InstigatedBy = InstigatedBy;
+	Effect.DamageCauser = DamageCauser;
+	Effect.DamageType = Spec.DamageType ? Spec.DamageType->GetDefaultObject<UDamageType>() : GetDefault<UDamageType>();
+	Effect.HealthPerSecond = Spec.HealthPerSecond;
+	Effect.RemainingTime = Spec.Duration;
+	Effect.Handle = NextHandle;
+	NextHandle = NextHandle == MAX_uint16 ? 1 : NextHandle + 1;
+
+	FStatusEffectRecord Record;
+	Record.Handle = Effect.Handle;
+	Record.Kind = Spec.Kind;
+	Record.StartTime = GetWorld()->GetTimeSeconds();
+	Record.Duration = Spec.Duration;
+	Record.HealthPerSecond = Spec.HealthPerSecond;
+	HealthComp->AddStatusEffectRecord(Record);
+
+	return Effect.Handle;
+}
+
+void UStatusEffectSubsystem::RemoveStatusEffect(int32 Handle)
+{
+	const int32 Index = Effects.IndexOfByPredicate([Handle](const FActiveStatusEffect& Effect)
+	{
+		return Effect.Handle == Handle;
+	});
+	if(Index != INDEX_NONE)
+	{
+		RemoveEffectAt(Index);
+	}
+}
+
+void UStatusEffectSubsystem::ClearStatusEffects(AActor* Target)
+{
+	for(int32 i = Effects.Num() - 1; i >= 0; --i)
+	{
+		const UHealthComponent* HealthComp = Effects[i].Target.Get();
+		if(!HealthComp || HealthComp->GetOwner() == Target)
+		{
+			RemoveEffectAt(i);
+		}
+	}
+}
+
+void UStatusEffectSubsystem::RemoveEffectAt(int32 Index)
+{
+	if(UHealthComponent* HealthComp = Effects[Index].Target.Get())
+	{
+		HealthComp->RemoveStatusEffectRecord(Effects[Index].Handle);
+	}
+	Effects.RemoveAtSwap(Index, 1, false);
+}
+
+void UStatusEffectSubsystem::Tick(float DeltaTime)
+{
+	if(GetWorld()->GetNetMode() == NM_Client || Effects.Num() == 0)
+	{
+		StepAccumulator = 0.0f;
+		return;
+	}
+
+	//Catch up all whole steps in a single pass instead of looping per step
+	const float StepInterval = FMath::Max(CVarStatusEffectStep.GetValueOnGameThread(), 0.01f);
+	StepAccumulator += DeltaTime;
+	const int32 NumSteps = FMath::FloorToInt(StepAccumulator / StepInterval);
+	if(NumSteps > 0)
+	{
+		StepAccumulator -= NumSteps * StepInterval;
+		ProcessStep(NumSteps * StepInterval);
+	}
+}
+
+void UStatusEffectSubsystem::ProcessStep(float StepTime)
+{
+	PendingDeltas.Reset();
+	PendingIndex.Reset();
+
+	for(int32 i = Effects.Num() - 1; i >= 0; --i)
+	{
+		FActiveStatusEffect& Effect = Effects[i];
+		UHealthComponent* HealthComp = Effect.Target.Get();
+		if(!HealthComp || HealthComp->IsDead())
+		{
+			RemoveEffectAt(i);
+			continue;
+		}
+
+		const float AppliedTime = FMath::Min(StepTime, Effect.RemainingTime);
+		Effect.RemainingTime -= AppliedTime;
+
+		int32& Index = PendingIndex.FindOrAdd(HealthComp, INDEX_NONE);
+		if(Index == INDEX_NONE)
+		{
+			Index = PendingDeltas.Add({HealthComp, 0.0f, nullptr, nullptr, nullptr});
+		}
+		FPendingHealthDelta& Pending = PendingDeltas[Index];
+		Pending.Delta += Effect.HealthPerSecond * AppliedTime;
+		//Damaging effects take credit for the change over regeneration
+		if(Effect.HealthPerSecond < 0.0f || !Pending.DamageType)
+		{
+			Pending.DamageType = Effect.DamageType;
+			Pending.InstigatedBy = Effect.InstigatedBy.Get();
+			Pending.DamageCauser = Effect.DamageCauser.Get();
+		}
+
+		if(Effect.RemainingTime <= 0.0f)
+		{
+			RemoveEffectAt(i);
+		}
+	}
+
+	for(const FPendingHealthDelta& Pending : PendingDeltas)
+	{
+		Pending.Target->ApplyStatusEffectDelta(Pending.Delta, Pending.DamageType, Pending.InstigatedBy, Pending.DamageCauser);
+	}
+}
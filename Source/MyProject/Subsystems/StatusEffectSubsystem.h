@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "../Components/StatusEffectTypes.h"
+#include "StatusEffectSubsystem.generated.h"
+
+class UHealthComponent;
+class UDamageType;
+
+//Server side state of a single running effect
+struct FActiveStatusEffect
+{
+	TWeakObjectPtr<UHealthComponent> Target;
+
+	TWeakObjectPtr<AController> InstigatedBy;
+
+	TWeakObjectPtr<AActor> DamageCauser;
+
+	const UDamageType* DamageType = nullptr;
+
+	float HealthPerSecond = 0.0f;
+
+	float RemainingTime = 0.0f;
+
+	uint16 Handle = 0;
+};
+
+/**
+ * Runs damage over time and regeneration for every UHealthComponent in the world.
+ * Effects live in one flat array and are processed at a fixed step, health changes are summed per victim
+ * and applied once. Clients only receive the effect start/stop records and interpolate health locally.
+ */
+UCLASS()
+class MYPROJECT_API UStatusEffectSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UFUNCTION(BlueprintCallable, Category = "StatusEffect")
+	int32 ApplyStatusEffect(AActor* Target, const FStatusEffectSpec& Spec, AController* InstigatedBy, AActor* DamageCauser);
+
+	UFUNCTION(BlueprintCallable, Category = "StatusEffect")
+	void RemoveStatusEffect(int32 Handle);
+
+	UFUNCTION(BlueprintCallable, Category = "StatusEffect")
+	void ClearStatusEffects(AActor* Target);
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	void ProcessStep(float StepTime);
+
+	void RemoveEffectAt(int32 Index);
+
+private:
+
+	TArray<FActiveStatusEffect> Effects;
+
+	//Per step scratch, one entry per victim
+	struct FPendingHealthDelta
+	{
+		UHealthComponent* Target;
+		float Delta;
+		const UDamageType* DamageType;
+		AController* InstigatedBy;
+		AActor* DamageCauser;
+	};
+	TArray<FPendingHealthDelta> PendingDeltas;
+	TMap<UHealthComponent*, int32> PendingIndex;
+
+	float StepAccumulator = 0.0f;
+
+	uint16 NextHandle = 1;
+};
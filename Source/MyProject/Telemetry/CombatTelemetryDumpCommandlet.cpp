@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombatTelemetryDumpCommandlet.h"
+
+#include "CombatTelemetryTypes.h"
+#include "Misc/FileHelper.h"
+
+static const TCHAR* GetEventName(ECombatTelemetryEvent Event)
+{
+	switch(Event)
+	{
+	case ECombatTelemetryEvent::Shot: return TEXT("Shot");
+	case ECombatTelemetryEvent::Hit: return TEXT("Hit");
+	case ECombatTelemetryEvent::Damage: return TEXT("Damage");
+	case ECombatTelemetryEvent::Kill: return TEXT("Kill");
+	case ECombatTelemetryEvent::Death: return TEXT("Death");
+	case ECombatTelemetryEvent::WeaponSwitch: return TEXT("WeaponSwitch");
+	case ECombatTelemetryEvent::Dropped: return TEXT("Dropped");
+	default: return TEXT("Unknown");
+	}
+}
+
+UCombatTelemetryDumpCommandlet::UCombatTelemetryDumpCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UCombatTelemetryDumpCommandlet::Main(const FString& Params)
+{
+	FString Filename;
+	if(!FParse::Value(*Params, TEXT("File="), Filename))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Usage: -run=CombatTelemetryDump -File=<path.mpct> [-Csv=<out.csv>]"));
+		return 1;
+	}
+
+	TArray<uint8> Data;
+	if(!FFileHelper::LoadFileToArray(Data, *Filename))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not read %s"), *Filename);
+		return 1;
+	}
+
+	FCombatTelemetryFileHeader Header;
+	if(Data.Num() < sizeof(Header))
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s is too small to be a telemetry file"), *Filename);
+		return 1;
+	}
+	FMemory::Memcpy(&Header, Data.GetData(), sizeof(Header));
+	if(Header.Magic != FCombatTelemetryFileHeader::ExpectedMagic || Header.RecordSize != sizeof(FCombatTelemetryRecord))
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s is not a version %u telemetry file"), *Filename, FCombatTelemetryFileHeader::CurrentVersion);
+		return 1;
+	}
+	//Records of another version may keep the size but not the meaning
+	if(Header.Version != FCombatTelemetryFileHeader::CurrentVersion)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s is a version %u telemetry file, this reader only understands version %u"), *Filename,
+			Header.Version, FCombatTelemetryFileHeader::CurrentVersion);
+		return 1;
+	}
+
+	//A file cut off by a crash simply ends at the last whole record
+	const int32 NumRecords = (Data.Num() - sizeof(Header)) / sizeof(FCombatTelemetryRecord);
+	const FCombatTelemetryRecord* Records = reinterpret_cast<const FCombatTelemetryRecord*>(Data.GetData() + sizeof(Header));
+
+	FString CsvFilename;
+	const bool bWriteCsv = FParse::Value(*Params, TEXT("Csv="), CsvFilename);
+	FString Csv;
+	if(bWriteCsv)
+	{
+		Csv.Reserve(NumRecords * 48);
+		Csv += TEXT("Time,Event,ActorId,TargetId,WeaponId,Value\n");
+	}
+
+	int32 Counts[static_cast<int32>(ECombatTelemetryEvent::Dropped) + 1] = {};
+	double TotalDamage = 0.0;
+	double TotalDropped = 0.0;
+	float LastTime = 0.0f;
+	for(int32 i = 0; i < NumRecords; ++i)
+	{
+		const FCombatTelemetryRecord& Record = Records[i];
+		const int32 EventIndex = static_cast<int32>(Record.Event);
+		if(EventIndex < UE_ARRAY_COUNT(Counts))
+		{
+			++Counts[EventIndex];
+		}
+		if(Record.Event == ECombatTelemetryEvent::Damage)
+		{
+			TotalDamage += Record.Value;
+		}
+		else if(Record.Event == ECombatTelemetryEvent::Dropped)
+		{
+			TotalDropped += Record.Value;
+		}
+		LastTime = FMath::Max(LastTime, Record.Time);
+
+		if(bWriteCsv)
+		{
+			Csv += FString::Printf(TEXT("%.3f,%s,%u,%u,%u,%.2f\n"), Record.Time, GetEventName(Record.Event),
+				Record.ActorId, Record.TargetId, Record.WeaponId, Record.Value);
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("%s: %d records over %.1fs, started %s"), *Filename, NumRecords, LastTime,
+		*FDateTime::FromUnixTimestamp(Header.StartTime).ToString());
+	for(int32 EventIndex = 0; EventIndex < UE_ARRAY_COUNT(Counts); ++EventIndex)
+	{
+		UE_LOG(LogTemp, Display, TEXT("  %-12s %d"), GetEventName(static_cast<ECombatTelemetryEvent>(EventIndex)), Counts[EventIndex]);
+	}
+	UE_LOG(LogTemp, Display, TEXT("  Total damage %.1f, dropped records %.0f"), TotalDamage, TotalDropped);
+
+	if(bWriteCsv && !FFileHelper::SaveStringToFile(Csv, *CsvFilename))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not write %s"), *CsvFilename);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CombatTelemetryDumpCommandlet.generated.h"
+
+/**
+ * Reads a match telemetry file written by UMatchTelemetrySubsystem.
+ * Usage: -run=CombatTelemetryDump -File=<path.mpct> [-Csv=<out.csv>]
+ */
+UCLASS()
+class UCombatTelemetryDumpCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCombatTelemetryDumpCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class ECombatTelemetryEvent : uint8
+{
+	Shot,
+	Hit,
+	Damage,
+	Kill,
+	Death,
+	WeaponSwitch,
+	//Written by the writer thread, Value holds the number of records dropped since the last one
+	Dropped
+};
+
+//Fixed size record, written to disk as is
+struct FCombatTelemetryRecord
+{
+	//World time in seconds
+	float Time = 0.0f;
+
+	//Per match ids of the acting and target actors, resolved through the .names sidecar
+	uint32 ActorId = 0;
+
+	uint32 TargetId = 0;
+
+	//Id of the weapon class, resolved through the .names sidecar
+	uint32 WeaponId = 0;
+
+	//Damage amount, remaining health etc. depending on the event
+	float Value = 0.0f;
+
+	ECombatTelemetryEvent Event = ECombatTelemetryEvent::Shot;
+
+	uint8 Padding[3] = {0, 0, 0};
+};
+static_assert(sizeof(FCombatTelemetryRecord) == 24, "Combat telemetry records are stored raw and must keep their size");
+
+struct FCombatTelemetryFileHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x5443504D; // "MPCT"
+	static constexpr uint32 CurrentVersion = 1;
+
+	uint32 Magic = ExpectedMagic;
+
+	uint32 Version = CurrentVersion;
+
+	uint32 RecordSize = sizeof(FCombatTelemetryRecord);
+
+	uint32 Reserved = 0;
+
+	//Unix time the match started at
+	int64 StartTime = 0;
+};
+static_assert(sizeof(FCombatTelemetryFileHeader) == 24, "Combat telemetry header is stored raw and must keep its size");
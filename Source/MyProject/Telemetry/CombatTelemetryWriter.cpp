@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombatTelemetryWriter.h"
+
+#include "HAL/PlatformFileManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Fork.h"
+#include "Misc/Paths.h"
+
+//Records written per file write call
+static constexpr int32 WriteBatchSize = 4096;
+
+FCombatTelemetryWriter::FCombatTelemetryWriter(uint32 QueueCapacity)
+	: Queue(QueueCapacity)
+{
+	WriteBuffer.Reserve(WriteBatchSize);
+}
+
+FCombatTelemetryWriter::~FCombatTelemetryWriter()
+{
+	Stop();
+}
+
+bool FCombatTelemetryWriter::Start(const FString& InFilename)
+{
+	check(!Thread);
+	Filename = InFilename;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Filename));
+	FileHandle.Reset(PlatformFile.OpenWrite(*Filename, true));
+	if(!FileHandle)
+	{
+		return false;
+	}
+
+	FCombatTelemetryFileHeader Header;
+	Header.StartTime = FDateTime::UtcNow().ToUnixTimestamp();
+	FileHandle->Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+
+	bStopping = false;
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	//Before a -WaitAndFork fork this only becomes a real thread in the forked match process
+	Thread = FForkProcessHelper::CreateForkableThread(this, TEXT("CombatTelemetryWriter"), 0, TPri_BelowNormal);
+	if(!Thread)
+	{
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		WakeEvent = nullptr;
+		FileHandle.Reset();
+		return false;
+	}
+	return true;
+}
+
+void FCombatTelemetryWriter::Stop()
+{
+	if(!Thread)
+	{
+		return;
+	}
+	bStopping = true;
+	WakeEvent->Trigger();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+	FileHandle.Reset();
+}
+
+uint32 FCombatTelemetryWriter::Run()
+{
+	while(!bStopping)
+	{
+		//Waking on a timer rather than per push keeps the game thread side a single enqueue
+		WakeEvent->Wait(100);
+		Drain();
+	}
+	return 0;
+}
+
+void FCombatTelemetryWriter::Exit()
+{
+	//Whatever was pushed before Stop() still goes to disk
+	Drain();
+	if(FileHandle)
+	{
+		FileHandle->Flush();
+	}
+}
+
+void FCombatTelemetryWriter::Drain()
+{
+	if(!FileHandle)
+	{
+		return;
+	}
+
+	bool bQueueEmpty = false;
+	while(!bQueueEmpty)
+	{
+		WriteBuffer.Reset();
+		FCombatTelemetryRecord Record;
+		while(WriteBuffer.Num() < WriteBatchSize - 1 && Queue.Dequeue(Record))
+		{
+			WriteBuffer.Add(Record);
+		}
+		bQueueEmpty = WriteBuffer.Num() < WriteBatchSize - 1;
+
+		if(const uint32 Dropped = DroppedRecords.exchange(0, std::memory_order_relaxed))
+		{
+			FCombatTelemetryRecord& DroppedRecord = WriteBuffer.AddDefaulted_GetRef();
+			DroppedRecord.Event = ECombatTelemetryEvent::Dropped;
+			DroppedRecord.Value = static_cast<float>(Dropped);
+		}
+
+		if(WriteBuffer.Num() > 0)
+		{
+			FileHandle->Write(reinterpret_cast<const uint8*>(WriteBuffer.GetData()), WriteBuffer.Num() * sizeof(FCombatTelemetryRecord));
+			NumWritten += WriteBuffer.Num();
+		}
+	}
+}
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CombatTelemetryTypes.h"
+#include "Containers/CircularQueue.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+class IFileHandle;
+
+/**
+ * Drains combat telemetry records on a background thread into an append-only binary file.
+ * Records are pushed from the game thread into a bounded lock-free queue; when the disk falls behind
+ * and the queue is full, records are dropped and counted instead of blocking or growing memory.
+ */
+class MYPROJECT_API FCombatTelemetryWriter : public FRunnable
+{
+public:
+
+	explicit FCombatTelemetryWriter(uint32 QueueCapacity);
+
+	virtual ~FCombatTelemetryWriter() override;
+
+	bool Start(const FString& InFilename);
+
+	//Flushes what is queued, closes the file and joins the thread
+	void Stop();
+
+	//Game thread only
+	void Push(const FCombatTelemetryRecord& Record)
+	{
+		if(!Queue.Enqueue(Record))
+		{
+			DroppedRecords.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	uint64 GetNumWritten() const {return NumWritten;}
+
+	//FRunnable
+	virtual uint32 Run() override;
+
+	virtual void Exit() override;
+
+private:
+
+	void Drain();
+
+	TCircularQueue<FCombatTelemetryRecord> Queue;
+
+	//Reused for every write so draining never allocates
+	TArray<FCombatTelemetryRecord> WriteBuffer;
+
+	TUniquePtr<IFileHandle> FileHandle;
+
+	FRunnableThread* Thread = nullptr;
+
+	FEvent* WakeEvent = nullptr;
+
+	std::atomic<bool> bStopping{false};
+
+	std::atomic<uint32> DroppedRecords{0};
+
+	uint64 NumWritten = 0;
+
+	FString Filename;
+};
@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MatchTelemetrySubsystem.h"
+
+#include "CombatTelemetryWriter.h"
+#include "Engine/World.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/Fork.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+static TAutoConsoleVariable<bool> CVarMatchTelemetryEnabled(
+	TEXT("mp.MatchTelemetry.Enabled"),
+	true,
+	TEXT("Write per match combat telemetry on the server, read when a match starts."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMatchTelemetryQueueSize(
+	TEXT("mp.MatchTelemetry.QueueSize"),
+	65536,
+	TEXT("Records buffered between the game thread and the writer thread before new ones are dropped."),
+	ECVF_Default);
+
+bool UMatchTelemetrySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UMatchTelemetrySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+	if(InWorld.GetNetMode() == NM_Client || !CVarMatchTelemetryEnabled.GetValueOnGameThread())
+	{
+		return;
+	}
+	if(FForkProcessHelper::IsForkRequested() && !FForkProcessHelper::IsForkedChildProcess())
+	{
+		//Every forked match writes its own file, the fork parent never plays
+		FCoreDelegates::OnPostFork.AddUObject(this, &UMatchTelemetrySubsystem::HandlePostFork);
+		return;
+	}
+	StartWriter(InWorld);
+}
+
+void UMatchTelemetrySubsystem::HandlePostFork(EForkProcessRole Role)
+{
+	//The parent keeps the binding for the next fork
+	if(Role == EForkProcessRole::Child)
+	{
+		FCoreDelegates::OnPostFork.RemoveAll(this);
+		StartWriter(*GetWorld());
+	}
+}
+
+void UMatchTelemetrySubsystem::StartWriter(const UWorld& InWorld)
+{
+	FString Suffix = FDateTime::Now().ToString();
+	if(FForkProcessHelper::IsForkedChildProcess())
+	{
+		Suffix += FString::Printf(TEXT("_%u"), FPlatformProcess::GetCurrentProcessId());
+	}
+	Filename = FPaths::ProjectSavedDir() / TEXT("Telemetry") /
+		FString::Printf(TEXT("Match_%s_%s.mpct"), *InWorld.GetMapName(), *Suffix);
+	Writer = MakeUnique<FCombatTelemetryWriter>(FMath::Max(CVarMatchTelemetryQueueSize.GetValueOnGameThread(), 1024));
+	if(!Writer->Start(Filename))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Could not open match telemetry file %s"), *Filename);
+		Writer.Reset();
+	}
+}
+
+void UMatchTelemetrySubsystem::Deinitialize()
+{
+	FCoreDelegates::OnPostFork.RemoveAll(this);
+	if(Writer)
+	{
+		Writer->Stop();
+		Writer.Reset();
+		WriteNames();
+	}
+	Super::Deinitialize();
+}
+
+void UMatchTelemetrySubsystem::Record(const UObject* WorldContextObject, ECombatTelemetryEvent Event, const AActor* Actor,
+	const AActor* Target, const UObject* Weapon, float Value)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	UMatchTelemetrySubsystem* Telemetry = World ? World->GetSubsystem<UMatchTelemetrySubsystem>() : nullptr;
+	if(!Telemetry || !Telemetry->Writer)
+	{
+		return;
+	}
+
+	FCombatTelemetryRecord Record;
+	Record.Time = World->GetTimeSeconds();
+	Record.Event = Event;
+	Record.ActorId = Telemetry->GetActorId(Actor);
+	Record.TargetId = Telemetry->GetActorId(Target);
+	Record.WeaponId = Telemetry->GetWeaponId(Weapon);
+	Record.Value = Value;
+	Telemetry->Writer->Push(Record);
+}
+
+uint32 UMatchTelemetrySubsystem::GetActorId(const AActor* Actor)
+{
+	if(!Actor)
+	{
+		return 0;
+	}
+	if(const uint32* Id = ActorIds.Find(Actor))
+	{
+		return *Id;
+	}
+	const uint32 Id = ActorIds.Num() + 1;
+	ActorNameLines.Add(FString::Printf(TEXT("actor %u %s"), Id, *Actor->GetName()));
+	return ActorIds.Add(Actor, Id);
+}
+
+uint32 UMatchTelemetrySubsystem::GetWeaponId(const UObject* Weapon)
+{
+	if(!Weapon)
+	{
+		return 0;
+	}
+	const UClass* WeaponClass = Weapon->GetClass();
+	if(const uint32* Id = WeaponIds.Find(WeaponClass))
+	{
+		return *Id;
+	}
+	return WeaponIds.Add(WeaponClass, WeaponIds.Num() + 1);
+}
+
+void UMatchTelemetrySubsystem::WriteNames() const
+{
+	TArray<FString> Lines = ActorNameLines;
+	for(const TPair<const UClass*, uint32>& Weapon : WeaponIds)
+	{
+		Lines.Add(FString::Printf(TEXT("weapon %u %s"), Weapon.Value, *Weapon.Key->GetPathName()));
+	}
+	FFileHelper::SaveStringArrayToFile(Lines, *(Filename + TEXT(".names")));
+}
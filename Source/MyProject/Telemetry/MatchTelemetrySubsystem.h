@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/CoreDelegates.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatTelemetryTypes.h"
+#include "MatchTelemetrySubsystem.generated.h"
+
+class FCombatTelemetryWriter;
+
+/**
+ * Per match combat telemetry on the server. One file is written per world, so matches rotate with map travel.
+ * Producers call Record() on the game thread, the writing happens on FCombatTelemetryWriter's thread.
+ */
+UCLASS()
+class MYPROJECT_API UMatchTelemetrySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static void Record(const UObject* WorldContextObject, ECombatTelemetryEvent Event, const AActor* Actor,
+		const AActor* Target = nullptr, const UObject* Weapon = nullptr, float Value = 0.0f);
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Deinitialize() override;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	void StartWriter(const UWorld& InWorld);
+
+	void HandlePostFork(EForkProcessRole Role);
+
+	uint32 GetActorId(const AActor* Actor);
+
+	uint32 GetWeaponId(const UObject* Weapon);
+
+	void WriteNames() const;
+
+private:
+
+	TUniquePtr<FCombatTelemetryWriter> Writer;
+
+	FString Filename;
+
+	//Ids only increase within a match, so an id never names two actors even when object slots are reused
+	TMap<TObjectKey<AActor>, uint32> ActorIds;
+
+	//Name lines added as ids are assigned, written to the .names sidecar when the match ends
+	TArray<FString> ActorNameLines;
+
+	TMap<const UClass*, uint32> WeaponIds;
+};
@@ -0,0 +1,231 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "../Telemetry/ReplayBenchmarkSubsystem.h"
+
+#include "Engine/DemoNetDriver.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogReplayBenchmark, Log, All);
+
+void FReplayBenchmarkTimestampTick::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+	const FGraphEventRef& MyCompletionGraphEvent)
+{
+	Timestamp = FPlatformTime::Seconds();
+}
+
+FString FReplayBenchmarkTimestampTick::DiagnosticMessage()
+{
+	return TEXT("FReplayBenchmarkTimestampTick");
+}
+
+void UReplayBenchmarkSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	FParse::Value(FCommandLine::Get(), TEXT("ReplayRecord="), RecordName);
+	FParse::Value(FCommandLine::Get(), TEXT("ReplayBenchmark="), BenchmarkName);
+	if(RecordName.IsEmpty() && BenchmarkName.IsEmpty())
+	{
+		return;
+	}
+	FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UReplayBenchmarkSubsystem::HandlePostLoadMap);
+
+	if(!BenchmarkName.IsEmpty())
+	{
+		//Same simulated frames on every run, the engine does not wait between them
+		int32 Fps = 30;
+		FParse::Value(FCommandLine::Get(), TEXT("BenchmarkFPS="), Fps);
+		FApp::SetBenchmarking(true);
+		FApp::SetUseFixedTimeStep(true);
+		FApp::SetFixedDeltaTime(1.0 / FMath::Max(Fps, 1));
+
+		FNetworkReplayDelegates::OnReplayStarted.AddUObject(this, &UReplayBenchmarkSubsystem::HandleReplayStarted);
+		FNetworkReplayDelegates::OnReplayPlaybackComplete.AddUObject(this, &UReplayBenchmarkSubsystem::HandleReplayPlaybackComplete);
+		FWorldDelegates::OnWorldCleanup.AddUObject(this, &UReplayBenchmarkSubsystem::HandleWorldCleanup);
+	}
+}
+
+void UReplayBenchmarkSubsystem::Deinitialize()
+{
+	StopCapture();
+	if(bRecording)
+	{
+		GetGameInstance()->StopRecordingReplay();
+		bRecording = false;
+	}
+	FCoreUObjectDelegates::PostLoadMapWithWorld.RemoveAll(this);
+	FNetworkReplayDelegates::OnReplayStarted.RemoveAll(this);
+	FNetworkReplayDelegates::OnReplayPlaybackComplete.RemoveAll(this);
+	FWorldDelegates::OnWorldCleanup.RemoveAll(this);
+	Super::Deinitialize();
+}
+
+void UReplayBenchmarkSubsystem::HandlePostLoadMap(UWorld* World)
+{
+	if(!RecordName.IsEmpty() && !bRecording)
+	{
+		bRecording = true;
+		GetGameInstance()->StartRecordingReplay(RecordName, RecordName);
+		UE_LOG(LogReplayBenchmark, Display, TEXT("Recording replay %s"), *RecordName);
+	}
+	if(!BenchmarkName.IsEmpty() && !bPlaybackRequested)
+	{
+		bPlaybackRequested = true;
+		if(!GetGameInstance()->PlayReplay(BenchmarkName))
+		{
+			UE_LOG(LogReplayBenchmark, Error, TEXT("Could not play replay %s"), *BenchmarkName);
+			FPlatformMisc::RequestExit(false);
+		}
+	}
+}
+
+void UReplayBenchmarkSubsystem::HandleReplayStarted(UWorld* World)
+{
+	if(World && World->GetGameInstance() == GetGameInstance())
+	{
+		StartCapture(World);
+	}
+}
+
+void UReplayBenchmarkSubsystem::HandleReplayPlaybackComplete(UWorld* World)
+{
+	if(!CaptureWorld.IsValid() || World != CaptureWorld.Get())
+	{
+		return;
+	}
+	StopCapture();
+	WriteCsv();
+	FPlatformMisc::RequestExit(false);
+}
+
+void UReplayBenchmarkSubsystem::HandleWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+	if(World == CaptureWorld.Get())
+	{
+		StopCapture();
+	}
+}
+
+void UReplayBenchmarkSubsystem::StartCapture(UWorld* World)
+{
+	StopCapture();
+	CaptureWorld = World;
+	Frames.Reset();
+	Frames.Reserve(32 * 1024);
+
+	PhysicsStartTick.TickGroup = TG_StartPhysics;
+	PhysicsStartTick.bCanEverTick = true;
+	PhysicsStartTick.RegisterTickFunction(World->PersistentLevel);
+	World->StartPhysicsTickFunction.AddPrerequisite(World, PhysicsStartTick);
+
+	PhysicsEndTick.TickGroup = TG_EndPhysics;
+	PhysicsEndTick.bCanEverTick = true;
+	PhysicsEndTick.RegisterTickFunction(World->PersistentLevel);
+	PhysicsEndTick.AddPrerequisite(World, World->EndPhysicsTickFunction);
+
+	FCoreDelegates::OnBeginFrame.AddUObject(this, &UReplayBenchmarkSubsystem::HandleBeginFrame);
+	FCoreDelegates::OnEndFrame.AddUObject(this, &UReplayBenchmarkSubsystem::HandleEndFrame);
+	FWorldDelegates::OnWorldTickStart.AddUObject(this, &UReplayBenchmarkSubsystem::HandleWorldTickStart);
+	World->OnPostTickDispatch().AddUObject(this, &UReplayBenchmarkSubsystem::HandlePostTickDispatch);
+
+	UE_LOG(LogReplayBenchmark, Display, TEXT("Benchmarking replay %s at %.1f fps"), *BenchmarkName, 1.0 / FApp::GetFixedDeltaTime());
+}
+
+void UReplayBenchmarkSubsystem::StopCapture()
+{
+	if(UWorld* World = CaptureWorld.Get())
+	{
+		World->StartPhysicsTickFunction.RemovePrerequisite(World, PhysicsStartTick);
+		World->OnPostTickDispatch().RemoveAll(this);
+	}
+	PhysicsStartTick.UnRegisterTickFunction();
+	PhysicsEndTick.UnRegisterTickFunction();
+	FCoreDelegates::OnBeginFrame.RemoveAll(this);
+	FCoreDelegates::OnEndFrame.RemoveAll(this);
+	FWorldDelegates::OnWorldTickStart.RemoveAll(this);
+	CaptureWorld.Reset();
+}
+
+void UReplayBenchmarkSubsystem::HandleBeginFrame()
+{
+	FrameStartTime = FPlatformTime::Seconds();
+	PhysicsStartTick.Timestamp = 0.0;
+	PhysicsEndTick.Timestamp = 0.0;
+	DispatchStartTime = 0.0;
+	DispatchEndTime = 0.0;
+}
+
+void UReplayBenchmarkSubsystem::HandleWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaTime)
+{
+	if(World == CaptureWorld.Get())
+	{
+		DispatchStartTime = FPlatformTime::Seconds();
+	}
+}
+
+void UReplayBenchmarkSubsystem::HandlePostTickDispatch()
+{
+	DispatchEndTime = FPlatformTime::Seconds();
+}
+
+void UReplayBenchmarkSubsystem::HandleEndFrame()
+{
+	const UWorld* World = CaptureWorld.Get();
+	const UDemoNetDriver* DemoNetDriver = World ? World->GetDemoNetDriver() : nullptr;
+	if(!DemoNetDriver)
+	{
+		return;
+	}
+	auto ToMs = [](double Start, double End)
+	{
+		return Start > 0.0 && End > Start ? static_cast<float>((End - Start) * 1000.0) : 0.0f;
+	};
+	FReplayBenchmarkFrame& Frame = Frames.AddDefaulted_GetRef();
+	Frame.DemoTime = DemoNetDriver->GetDemoCurrentTime();
+	Frame.GameThreadMs = ToMs(FrameStartTime, FPlatformTime::Seconds());
+	Frame.PhysicsMs = ToMs(PhysicsStartTick.Timestamp, PhysicsEndTick.Timestamp);
+	Frame.ReplicationMs = ToMs(DispatchStartTime, DispatchEndTime);
+}
+
+void UReplayBenchmarkSubsystem::WriteCsv() const
+{
+	FString Filename;
+	if(!FParse::Value(FCommandLine::Get(), TEXT("ReplayBenchmarkCsv="), Filename))
+	{
+		Filename = FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("ReplayBenchmark") /
+			FPaths::MakeValidFileName(FString::Printf(TEXT("%s_%s_%s.csv"), *BenchmarkName, FApp::GetBuildVersion(),
+				*FDateTime::Now().ToString()));
+	}
+
+	FString Rows = TEXT("Frame,DemoTime,GameThreadMs,PhysicsMs,ReplicationMs\n");
+	float Totals[3] = {0.0f, 0.0f, 0.0f};
+	float Peaks[3] = {0.0f, 0.0f, 0.0f};
+	for(int32 i = 0; i < Frames.Num(); ++i)
+	{
+		const FReplayBenchmarkFrame& Frame = Frames[i];
+		Rows += FString::Printf(TEXT("%d,%.4f,%.3f,%.3f,%.3f\n"), i, Frame.DemoTime, Frame.GameThreadMs, Frame.PhysicsMs,
+			Frame.ReplicationMs);
+		const float Values[3] = {Frame.GameThreadMs, Frame.PhysicsMs, Frame.ReplicationMs};
+		for(int32 j = 0; j < 3; ++j)
+		{
+			Totals[j] += Values[j];
+			Peaks[j] = FMath::Max(Peaks[j], Values[j]);
+		}
+	}
+	FFileHelper::SaveStringToFile(Rows, *Filename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+
+	const float NumFrames = FMath::Max(Frames.Num(), 1);
+	UE_LOG(LogReplayBenchmark, Display, TEXT("%d frames written to %s"), Frames.Num(), *Filename);
+	UE_LOG(LogReplayBenchmark, Display, TEXT("  game thread avg %.3f ms, max %.3f ms"), Totals[0] / NumFrames, Peaks[0]);
+	UE_LOG(LogReplayBenchmark, Display, TEXT("  physics     avg %.3f ms, max %.3f ms"), Totals[1] / NumFrames, Peaks[1]);
+	UE_LOG(LogReplayBenchmark, Display, TEXT("  replication avg %.3f ms, max %.3f ms"), Totals[2] / NumFrames, Peaks[2]);
+}
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "ReplayBenchmarkSubsystem.generated.h"
+
+//Stamps the time it runs at, a pair of these brackets the physics tick groups
+struct FReplayBenchmarkTimestampTick : public FTickFunction
+{
+	double Timestamp = 0.0;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+		const FGraphEventRef& MyCompletionGraphEvent) override;
+
+	virtual FString DiagnosticMessage() override;
+};
+
+struct FReplayBenchmarkFrame
+{
+	float DemoTime;
+
+	float GameThreadMs;
+
+	//From the start of TG_StartPhysics until EndPhysics completes, includes during physics ticks
+	float PhysicsMs;
+
+	//Demo driver dispatch: reading the recorded frame, spawning actors and running OnReps
+	float ReplicationMs;
+};
+
+/**
+ * Records a replay with -ReplayRecord=<Name>, or plays one back as a benchmark with -ReplayBenchmark=<Name>.
+ * Playback runs at a fixed timestep (-BenchmarkFPS=, default 30) as fast as the machine allows, so two builds
+ * replaying the same recording produce the same frames and their CSVs compare row by row. Meant to run headless:
+ *   MyProject -ReplayBenchmark=BusyMatch -nullrhi -unattended [-ReplayBenchmarkCsv=Path]
+ * Rows are kept in memory and written when playback completes, then the process exits.
+ */
+UCLASS()
+class MYPROJECT_API UReplayBenchmarkSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+protected:
+
+	void HandlePostLoadMap(UWorld* World);
+
+	void HandleReplayStarted(UWorld* World);
+
+	void HandleReplayPlaybackComplete(UWorld* World);
+
+	void HandleWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+	void HandleBeginFrame();
+
+	void HandleEndFrame();
+
+	void HandleWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaTime);
+
+	void HandlePostTickDispatch();
+
+	void StartCapture(UWorld* World);
+
+	void StopCapture();
+
+	void WriteCsv() const;
+
+private:
+
+	FString RecordName;
+
+	FString BenchmarkName;
+
+	bool bRecording = false;
+
+	bool bPlaybackRequested = false;
+
+	TWeakObjectPtr<UWorld> CaptureWorld;
+
+	FReplayBenchmarkTimestampTick PhysicsStartTick;
+
+	FReplayBenchmarkTimestampTick PhysicsEndTick;
+
+	double FrameStartTime = 0.0;
+
+	double DispatchStartTime = 0.0;
+
+	double DispatchEndTime = 0.0;
+
+	TArray<FReplayBenchmarkFrame> Frames;
+};
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../Subsystems/ActorPoolSubsystem.h"
+#include "../Weapons/ProjectileBase.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FActorPoolReuseTest, "MyProject.ActorPool.ReusesReleasedProjectile",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext | EAutomationTestFlags::EngineFilter)
+
+bool FActorPoolReuseTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	UActorPoolSubsystem* ActorPool = World->GetSubsystem<UActorPoolSubsystem>();
+	if(TestNotNull(TEXT("Actor pool"), ActorPool))
+	{
+		const FTransform FirstTransform(FRotator::ZeroRotator, FVector(0.0f, 0.0f, 1000.0f));
+		AProjectileBase* First = Cast<AProjectileBase>(ActorPool->AcquireActor(AProjectileBase::StaticClass(), FirstTransform,
+			nullptr, nullptr));
+		if(TestNotNull(TEXT("Spawned projectile"), First))
+		{
+			ActorPool->ReleaseActor(First);
+			//A second release, e.g. a hit followed by the life span running out, must not pool it twice
+			ActorPool->ReleaseActor(First);
+			TestTrue(TEXT("Released projectile is hidden"), First->IsHidden());
+			TestTrue(TEXT("Released projectile has no velocity"), First->GetProjectileMovement()->Velocity.IsZero());
+			TestFalse(TEXT("Released projectile has no collision"), First->GetActorEnableCollision());
+
+			const FTransform SecondTransform(FRotator(0.0f, 90.0f, 0.0f), FVector(500.0f, 0.0f, 1000.0f));
+			AActor* Second = ActorPool->AcquireActor(AProjectileBase::StaticClass(), SecondTransform, nullptr, nullptr);
+			TestTrue(TEXT("Released projectile is reused"), Second == First);
+			TestFalse(TEXT("Reused projectile is shown"), First->IsHidden());
+			TestTrue(TEXT("Reused projectile has collision"), First->GetActorEnableCollision());
+			TestTrue(TEXT("Reused projectile is moved"), First->GetActorLocation().Equals(SecondTransform.GetLocation()));
+			TestTrue(TEXT("Reused projectile flies along its new rotation"), First->GetProjectileMovement()->Velocity.Equals(
+				SecondTransform.GetRotation().GetForwardVector() * First->GetProjectileMovement()->InitialSpeed, 0.1f));
+			TestTrue(TEXT("Reused projectile has its life span again"),
+				World->GetTimerManager().IsTimerActive(First->GetLifeSpanTimer()));
+
+			AActor* Third = ActorPool->AcquireActor(AProjectileBase::StaticClass(), FirstTransform, nullptr, nullptr);
+			TestTrue(TEXT("Double released projectile is not handed out twice"), Third && Third != First);
+		}
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	return true;
+}
+
+#endif
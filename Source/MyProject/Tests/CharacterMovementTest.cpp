@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "../Components/MyProjectCharacterMovementComponent.h"
+#include "../MyProjectCharacter.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCharacterMovementSavedMoveTest, "MyProject.CharacterMovement.SavedMoveSpeeds",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext | EAutomationTestFlags::EngineFilter)
+
+bool FCharacterMovementSavedMoveTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AMyProjectCharacter* Character = World->SpawnActor<AMyProjectCharacter>(AMyProjectCharacter::StaticClass(), FTransform::Identity,
+		SpawnParameters);
+	UMyProjectCharacterMovementComponent* Movement = Character ? Character->GetMyCharacterMovement() : nullptr;
+	if(TestNotNull(TEXT("Character movement"), Movement))
+	{
+		Movement->SetMovementMode(MOVE_Walking);
+
+		Movement->SetWantsToSprint(true);
+		TestEqual(TEXT("Sprinting speed"), Movement->GetMaxSpeed(), Movement->SprintSpeed);
+
+		//The flags travel in the saved move, the server rebuilds them from the compressed flags
+		FSavedMove_MyProject Move;
+		Move.Clear();
+		Move.SetMoveFor(Character, 1.0f / 60.0f, FVector::ZeroVector,
+			*static_cast<FNetworkPredictionData_Client_Character*>(Movement->GetPredictionData_Client()));
+		const uint8 Flags = Move.GetCompressedFlags();
+		Movement->SetWantsToSprint(false);
+		Movement->UpdateFromCompressedFlags(Flags);
+		TestEqual(TEXT("Sprinting speed from the saved move"), Movement->GetMaxSpeed(), Movement->SprintSpeed);
+
+		//Crouched players are capped at the crouched speed while sprinting or aiming, on both ends of the move
+		Character->bIsCrouched = true;
+		TestEqual(TEXT("Crouched speed while sprinting"), Movement->GetMaxSpeed(), Movement->MaxWalkSpeedCrouched);
+		TestFalse(TEXT("Crouched players do not sprint"), Movement->IsSprinting());
+
+		Movement->SetWantsToSprint(false);
+		Movement->SetWantsToAim(true);
+		TestEqual(TEXT("Crouched speed while aiming"), Movement->GetMaxSpeed(), Movement->MaxWalkSpeedCrouched);
+
+		Move.Clear();
+		Move.SetMoveFor(Character, 1.0f / 60.0f, FVector::ZeroVector,
+			*static_cast<FNetworkPredictionData_Client_Character*>(Movement->GetPredictionData_Client()));
+		Movement->SetWantsToAim(false);
+		Move.PrepMoveFor(Character);
+		TestTrue(TEXT("Replayed move restores aiming"), Movement->IsAiming());
+		TestEqual(TEXT("Crouched speed in a replayed move"), Movement->GetMaxSpeed(), Movement->MaxWalkSpeedCrouched);
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	return true;
+}
+
+#endif
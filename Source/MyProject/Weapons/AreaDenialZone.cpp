@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AreaDenialZone.h"
+
+#include "../Subsystems/DamageableSpatialHashSubsystem.h"
+#include "../Subsystems/ServerBudgetGovernorSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+
+AAreaDenialZone::AAreaDenialZone()
+{
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	Radius = 400.0f;
+	DamagePerSecond = 10.0f;
+	ZoneLifeSpan = 8.0f;
+	bCheckOcclusion = false;
+	ZoneEffect = nullptr;
+
+	//Damage is applied in pulses, there is no need to query every frame
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickInterval = 0.5f;
+
+	SetReplicates(true);
+}
+
+void AAreaDenialZone::BeginPlay()
+{
+	Super::BeginPlay();
+	SetActorTickEnabled(HasAuthority());
+	SetLifeSpan(ZoneLifeSpan);
+
+	if(ZoneEffect && !IsNetMode(NM_DedicatedServer))
+	{
+		//Only for show, dropped while a listen server is over budget
+		UServerBudgetGovernorSubsystem::RunCosmetic(this, [WeakThis = TWeakObjectPtr<AAreaDenialZone>(this)]()
+		{
+			if(AAreaDenialZone* Zone = WeakThis.Get())
+			{
+				UGameplayStatics::SpawnEmitterAttached(Zone->ZoneEffect, Zone->GetRootComponent(), NAME_None, FVector::ZeroVector,
+					FRotator::ZeroRotator, EAttachLocation::KeepRelativeOffset, true, EPSCPoolMethod::None);
+			}
+		});
+	}
+}
+
+void AAreaDenialZone::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if(UDamageableSpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<UDamageableSpatialHashSubsystem>())
+	{
+		const float Damage = DamagePerSecond * DeltaTime;
+		SpatialHash->ApplyRadialDamage(GetActorLocation(), Damage, Damage, 0.0f, Radius, DamageType, this,
+			GetInstigatorController(), TArray<AActor*>(), bCheckOcclusion);
+	}
+}
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "AreaDenialZone.generated.h"
+
+class UDamageType;
+class UParticleSystem;
+
+//Zone left behind by grenades and fire, damages everything inside it through the damageable spatial hash
+UCLASS()
+class MYPROJECT_API AAreaDenialZone : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AAreaDenialZone();
+
+protected:
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Zone")
+	float Radius;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Zone")
+	float DamagePerSecond;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Zone")
+	float ZoneLifeSpan;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Zone")
+	TSubclassOf<UDamageType> DamageType;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Zone")
+	bool bCheckOcclusion;
+
+	//Optional looping visual attached to the zone, never spawned on dedicated servers
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Zone")
+	UParticleSystem* ZoneEffect;
+
+	virtual void BeginPlay() override;
+
+	virtual void Tick(float DeltaTime) override;
+};
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ProjectileBase.h"
+
+#include "Components/SphereComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "TimerManager.h"
+#include "../Subsystems/ActorPoolSubsystem.h"
+#include "../Subsystems/DamageableSpatialHashSubsystem.h"
+
+AProjectileBase::AProjectileBase()
+{
+	CollisionComponent = CreateDefaultSubobject<USphereComponent>(TEXT("CollisionComponent"));
+	CollisionComponent->InitSphereRadius(5.0f);
+	CollisionComponent->SetCollisionProfileName(UCollisionProfile::BlockAllDynamic_ProfileName);
+	CollisionComponent->OnComponentHit.AddDynamic(this, &AProjectileBase::OnHit);
+	CollisionComponent->CanCharacterStepUpOn = ECB_No;
+	RootComponent = CollisionComponent;
+
+	ProjectileMovement = CreateDefaultSubobject<UProjectileMovementComponent>(TEXT("ProjectileMovement"));
+	ProjectileMovement->UpdatedComponent = CollisionComponent;
+	ProjectileMovement->InitialSpeed = 3000.0f;
+	ProjectileMovement->MaxSpeed = 3000.0f;
+	ProjectileMovement->bRotationFollowsVelocity = true;
+
+	BaseDamage = 20.0f;
+	ExplosionRadius = 0.0f;
+	ExplosionInnerRadius = 0.0f;
+	MinimumExplosionDamage = 0.0f;
+	ProjectileLifeSpan = 3.0f;
+
+	SetReplicates(true);
+	SetReplicateMovement(true);
+}
+
+void AProjectileBase::OnAcquiredFromPool_Implementation()
+{
+	//Same state a freshly spawned projectile starts with, aimed along the new transform
+	CollisionComponent->ClearMoveIgnoreActors();
+	CollisionComponent->IgnoreActorWhenMoving(GetOwner(), true);
+	CollisionComponent->IgnoreActorWhenMoving(GetInstigator(), true);
+	CollisionComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+
+	ProjectileMovement->SetUpdatedComponent(CollisionComponent);
+	ProjectileMovement->Velocity = GetActorForwardVector() * ProjectileMovement->InitialSpeed;
+	ProjectileMovement->UpdateComponentVelocity();
+	ProjectileMovement->Activate(true);
+
+	if(HasAuthority())
+	{
+		GetWorldTimerManager().SetTimer(TimerHandle_LifeSpan, this, &AProjectileBase::ReturnToPool, ProjectileLifeSpan);
+	}
+}
+
+void AProjectileBase::OnReleasedToPool_Implementation()
+{
+	GetWorldTimerManager().ClearTimer(TimerHandle_LifeSpan);
+
+	ProjectileMovement->StopMovementImmediately();
+	ProjectileMovement->Deactivate();
+
+	CollisionComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	CollisionComponent->ClearMoveIgnoreActors();
+}
+
+void AProjectileBase::OnHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
+	FVector NormalImpulse, const FHitResult& Hit)
+{
+	if(!HasAuthority())
+	{
+		return;
+	}
+	if(ExplosionRadius > 0.0f)
+	{
+		//Lifted off the surface so the occlusion traces do not start inside what was hit
+		Explode(Hit.ImpactPoint + Hit.ImpactNormal * 10.0f);
+	}
+	else if(OtherActor && OtherActor != this)
+	{
+		UGameplayStatics::ApplyPointDamage(OtherActor, BaseDamage, GetVelocity().GetSafeNormal(), Hit, GetInstigatorController(),
+			this, DamageType);
+	}
+	ReturnToPool();
+}
+
+void AProjectileBase::Explode(const FVector& Location)
+{
+	if(UDamageableSpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<UDamageableSpatialHashSubsystem>())
+	{
+		SpatialHash->ApplyRadialDamage(Location, BaseDamage, MinimumExplosionDamage, ExplosionInnerRadius, ExplosionRadius,
+			DamageType, this, GetInstigatorController(), TArray<AActor*>());
+	}
+}
+
+void AProjectileBase::ReturnToPool()
+{
+	if(UActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UActorPoolSubsystem>())
+	{
+		ActorPool->ReleaseActor(this);
+	}
+	else
+	{
+		Destroy();
+	}
+}
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "../Subsystems/PooledActor.h"
+#include "ProjectileBase.generated.h"
+
+class USphereComponent;
+class UProjectileMovementComponent;
+class UDamageType;
+
+//Projectile fired by AProjectileBaseWeapon, recycled through UActorPoolSubsystem instead of being destroyed
+UCLASS()
+class MYPROJECT_API AProjectileBase : public AActor, public IPooledActor
+{
+	GENERATED_BODY()
+
+public:
+	AProjectileBase();
+
+	UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
+
+	const FTimerHandle& GetLifeSpanTimer() const { return TimerHandle_LifeSpan; }
+
+	virtual void OnAcquiredFromPool_Implementation() override;
+
+	virtual void OnReleasedToPool_Implementation() override;
+
+protected:
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Projectile")
+	USphereComponent* CollisionComponent;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Projectile")
+	UProjectileMovementComponent* ProjectileMovement;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile")
+	float BaseDamage;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile")
+	TSubclassOf<UDamageType> DamageType;
+
+	//Above 0 the projectile explodes on impact, damaging everything within the radius through the damageable spatial hash
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile|Explosion")
+	float ExplosionRadius;
+
+	//Full damage within this radius, falling off to MinimumExplosionDamage at ExplosionRadius
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile|Explosion")
+	float ExplosionInnerRadius;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile|Explosion")
+	float MinimumExplosionDamage;
+
+	//Seconds until an unimpeded projectile goes back to the pool, replaces the actor life span
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile")
+	float ProjectileLifeSpan;
+
+	FTimerHandle TimerHandle_LifeSpan;
+
+	UFUNCTION()
+	void OnHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse,
+		const FHitResult& Hit);
+
+	void Explode(const FVector& Location);
+
+	void ReturnToPool();
+};
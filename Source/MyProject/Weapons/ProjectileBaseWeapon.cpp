@@ -3,6 +3,9 @@
 #include "ProjectileBaseWeapon.h"
 
 #include "Kismet/GameplayStatics.h"
+#include "ProjectileBase.h"
+#include "../Subsystems/ActorPoolSubsystem.h"
+#include "../Telemetry/MatchTelemetrySubsystem.h"
 
 AProjectileBaseWeapon::AProjectileBaseWeapon()
 {
@@ -11,7 +14,7 @@ AProjectileBaseWeapon::AProjectileBaseWeapon()
 	MuzzleSocket = "MuzzleFlash";
 	FireRate = 30;
 	MaxMagCapacity = 0;
-	bCanFire = true;
+	Projectile = AProjectileBase::StaticClass();
 
 	SetReplicates(true);
 
@@ -30,24 +33,19 @@ void AProjectileBaseWeapon::Fire()
 
 		FVector MuzzleLocation = WeaponMesh->GetSocketLocation(MuzzleSocket);
 
-		FActorSpawnParameters SpawnParam;
-		SpawnParam.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-		
-		GetWorld()->SpawnActor<AActor>(Projectile, MuzzleLocation, EyeRotation, SpawnParam);
-		
-		LastTimeFired = GetWorld()->TimeSeconds;
+		//Projectiles implementing IPooledActor are recycled, others are spawned as before
+		if(UActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UActorPoolSubsystem>())
+		{
+			ActorPool->AcquireActor(Projectile, FTransform(EyeRotation, MuzzleLocation), this, MyOwner->GetInstigator());
+		}
+		UMatchTelemetrySubsystem::Record(this, ECombatTelemetryEvent::Shot, MyOwner, nullptr, this);
 
 		if(FireSound)
 		{
 			UGameplayStatics::PlaySoundAtLocation(GetWorld(),FireSound,WeaponMesh->GetSocketLocation("MuzzleFlash"));
 		}
-		--Capacity;
-		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, FString::Printf(TEXT("%d"),Capacity));
-		if(Capacity <= 0)
-		{
-			StopFire();
-			bCanFire = false;
-		}
+		PlayWeaponAnimation(FireAnimation);
+		ConsumeShot();
 	}
 	
 }
@@ -20,6 +20,7 @@ protected:
 	
 	virtual void Fire() override;
 
+	//Blueprint projectiles should derive from AProjectileBase to be pooled
 	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
 	TSubclassOf<AActor> Projectile;
 };
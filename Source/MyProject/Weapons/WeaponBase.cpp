@@ -5,9 +5,15 @@
 
 
 #include "../Weapons/WeaponBase.h"
+#include "Animation/AnimMontage.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "Engine/DemoNetDriver.h"
 #include "Kismet/GameplayStatics.h"
 #include "Net/UnrealNetwork.h"
+#include "../Components/HealthComponent.h"
+#include "../Subsystems/NetBandwidthTelemetrySubsystem.h"
+#include "../Subsystems/ServerBudgetGovernorSubsystem.h"
+#include "../Telemetry/MatchTelemetrySubsystem.h"
 
 
 // Sets default values
@@ -15,11 +21,20 @@ AWeaponBase::AWeaponBase()
 {
 	WeaponMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("WeaponMesh"));
 	RootComponent = WeaponMesh;
+
+	//Idle weapons should cost close to a static mesh, skeletal work is only woken up for animations
+	PrimaryActorTick.bCanEverTick = false;
+	WeaponMesh->PrimaryComponentTick.bStartWithTickEnabled = false;
+	WeaponMesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+	WeaponMesh->bEnableUpdateRateOptimizations = true;
+	WeaponMesh->bComponentUseFixedSkelBounds = true;
+	WeaponMesh->bUseAttachParentBound = true;
+	WeaponMesh->KinematicBonesUpdateToPhysics = EKinematicBonesUpdateToPhysics::SkipAllBones;
+	WeaponMesh->SetGenerateOverlapEvents(false);
 	BaseDamage = 20.0f;
 	MuzzleSocket = "MuzzleFlash";
 	FireRate = 600;
 	MaxMagCapacity = 0;
-	bCanFire = true;
 
 	SetReplicates(true);
 
@@ -31,8 +46,31 @@ AWeaponBase::AWeaponBase()
 void AWeaponBase::BeginPlay()
 {
 	Super::BeginPlay();
-	Capacity = MaxMagCapacity;
-	TimeBetweenShots = 60 / FireRate;
+	SimState.Reset(GetSimConfig());
+	Capacity = SimState.Capacity;
+}
+
+FWeaponSimConfig AWeaponBase::GetSimConfig() const
+{
+	FWeaponSimConfig Config;
+	Config.BaseDamage = BaseDamage;
+	Config.FireRate = FireRate;
+	Config.MaxMagCapacity = MaxMagCapacity;
+	if(ReloadingMontage)
+	{
+		Config.ReloadTime = ReloadingMontage->GetPlayLength();
+	}
+	return Config;
+}
+
+void AWeaponBase::ConsumeShot()
+{
+	const bool bEmptied = SimState.ConsumeShot(GetWorld()->TimeSeconds);
+	Capacity = SimState.Capacity;
+	if(bEmptied)
+	{
+		StopFire();
+	}
 }
 
 void AWeaponBase::Fire()
@@ -58,12 +96,19 @@ void AWeaponBase::Fire()
 
 		FVector TraceEndPoint = TraceEnd;
 
+		UMatchTelemetrySubsystem::Record(this, ECombatTelemetryEvent::Shot, MyOwner, nullptr, this);
+
 		FHitResult Hit;
 		if (GetWorld()->LineTraceSingleByChannel(Hit, EyeLocation, TraceEnd, ECC_Visibility, QueryParams))
 		{
 			AActor* HitActor = Hit.GetActor();
 
 			UGameplayStatics::ApplyPointDamage(HitActor, BaseDamage, ShotDirection, Hit, MyOwner->GetInstigatorController(), this, DamageType);
+			//Only damageable targets count as hits, the Damage event from UHealthComponent carries the amount dealt
+			if(HitActor && HitActor->FindComponentByClass<UHealthComponent>())
+			{
+				UMatchTelemetrySubsystem::Record(this, ECombatTelemetryEvent::Hit, MyOwner, HitActor, this);
+			}
 
 			PlayImpactEffect(Hit.ImpactPoint);
 
@@ -76,30 +121,24 @@ void AWeaponBase::Fire()
 		if(GetLocalRole() == ROLE_Authority)
 		{
 			HitScanTrace.TraceTo = TraceEndPoint;
+			++HitScanTrace.ShotCount;
 		}
-		
-		LastTimeFired = GetWorld()->TimeSeconds;
 
 		if(FireSound)
 		{
 			UGameplayStatics::PlaySoundAtLocation(GetWorld(),FireSound,WeaponMesh->GetSocketLocation("MuzzleFlash"));
 		}
-		--Capacity;
-		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, FString::Printf(TEXT("%d"),Capacity));
-		if(Capacity <= 0)
-		{
-			StopFire();
-			bCanFire = false;
-		}
+		ConsumeShot();
 	}
 }
 
 void AWeaponBase::StartFire()
 {
-	if(bCanFire)
+	if(SimState.bCanFire)
 	{
-		float FireDelay = FMath::Max(LastTimeFired + TimeBetweenShots - GetWorld()->TimeSeconds, 0.0f);
-		GetWorldTimerManager().SetTimer(TimerHandle_TimeBetweenShots, this, &AWeaponBase::Fire,TimeBetweenShots, true, FireDelay);
+		const FWeaponSimConfig Config = GetSimConfig();
+		const float FireDelay = static_cast<float>(SimState.GetFireDelay(Config, GetWorld()->TimeSeconds));
+		GetWorldTimerManager().SetTimer(TimerHandle_TimeBetweenShots, this, &AWeaponBase::Fire,Config.GetTimeBetweenShots(), true, FireDelay);
 	}
 }
 
@@ -110,14 +149,21 @@ void AWeaponBase::StopFire()
 
 void AWeaponBase::Reload()
 {
-	WeaponMesh->PlayAnimation(ReloadingMontage,false);
-	Capacity = MaxMagCapacity;
-	bCanFire = true;
+	PlayWeaponAnimation(ReloadingMontage);
+	SimState.Reload(GetSimConfig());
+	Capacity = SimState.Capacity;
 }
 
 
+bool AWeaponBase::CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack)
+{
+	FNetTelemetrySendScope SendScope(this, Function);
+	return Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
+}
+
 void AWeaponBase::ServerFire_Implementation()
 {
+	UNetBandwidthTelemetrySubsystem::RecordServerRPC(this, GET_FUNCTION_NAME_CHECKED(AWeaponBase, ServerFire));
 	Fire();
 }
 
@@ -128,6 +174,12 @@ bool AWeaponBase::ServerFire_Validate()
 
 void AWeaponBase::OnRep_HitScanTrace()
 {
+	//Replay scrubbing restores the last trace of every weapon at once
+	const UDemoNetDriver* DemoNetDriver = GetWorld()->GetDemoNetDriver();
+	if(DemoNetDriver && DemoNetDriver->IsFastForwarding())
+	{
+		return;
+	}
 	PlayFireEffect(HitScanTrace.TraceTo);
 	PlayImpactEffect(HitScanTrace.TraceTo);
 }
@@ -139,22 +191,59 @@ void AWeaponBase::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifet
 	DOREPLIFETIME_CONDITION(AWeaponBase, HitScanTrace, COND_SkipOwner);
 }
 
+void AWeaponBase::PlayWeaponAnimation(UAnimationAsset* Animation)
+{
+	if(!Animation || IsNetMode(NM_DedicatedServer))
+	{
+		return;
+	}
+	WeaponMesh->SetComponentTickEnabled(true);
+	WeaponMesh->PlayAnimation(Animation, false);
+	GetWorldTimerManager().SetTimer(TimerHandle_MeshSleep, this, &AWeaponBase::SleepMesh, Animation->GetPlayLength(), false);
+}
+
+void AWeaponBase::SleepMesh()
+{
+	WeaponMesh->SetComponentTickEnabled(false);
+}
+
 void AWeaponBase::PlayFireEffect(FVector TraceEnd)
 {
+	if(IsNetMode(NM_DedicatedServer))
+	{
+		return;
+	}
+	PlayWeaponAnimation(FireAnimation);
 	if(MuzzleEffect)
 	{
-		UGameplayStatics::SpawnEmitterAttached(MuzzleEffect, WeaponMesh, MuzzleSocket);
+		//Pooled by the world, per shot emitters are not created and collected every shot. Dropped while a listen server is over budget
+		UServerBudgetGovernorSubsystem::RunCosmetic(this, [WeakMesh = TWeakObjectPtr<USkeletalMeshComponent>(WeaponMesh),
+			Effect = MuzzleEffect, Socket = MuzzleSocket]()
+		{
+			if(USkeletalMeshComponent* Mesh = WeakMesh.Get())
+			{
+				UGameplayStatics::SpawnEmitterAttached(Effect, Mesh, Socket, FVector::ZeroVector, FRotator::ZeroRotator,
+					EAttachLocation::KeepRelativeOffset, true, EPSCPoolMethod::AutoRelease);
+			}
+		});
 	}
 }
 
 void AWeaponBase::PlayImpactEffect(FVector ImpactPoint)
 {
-	if(ImpactEffect)
+	if(ImpactEffect && !IsNetMode(NM_DedicatedServer))
 	{
 		FVector MuzzleSocketLocation = WeaponMesh->GetSocketLocation(MuzzleSocket);
 		FVector ShotDirection = ImpactPoint - MuzzleSocketLocation;
 		ShotDirection.Normalize();
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ImpactEffect, ImpactPoint, ShotDirection.Rotation());
+		UServerBudgetGovernorSubsystem::RunCosmetic(this, [WeakWorld = TWeakObjectPtr<UWorld>(GetWorld()), Effect = ImpactEffect,
+			ImpactPoint, ImpactRotation = ShotDirection.Rotation()]()
+		{
+			if(UWorld* World = WeakWorld.Get())
+			{
+				UGameplayStatics::SpawnEmitterAtLocation(World, Effect, ImpactPoint, ImpactRotation, true, EPSCPoolMethod::AutoRelease);
+			}
+		});
 	}
 
 }
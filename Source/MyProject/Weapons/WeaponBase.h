@@ -4,10 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "../Simulation/CombatSim.h"
 #include "WeaponBase.generated.h"
 
 class USkeletalMeshComponent;
 class UDamageType;
+class UAnimationAsset;
 
 //Information of a single hitscan weapon linetrace
 USTRUCT()
@@ -17,6 +19,10 @@ struct FHitScanTrace
 
 	UPROPERTY()
 	FVector_NetQuantize TraceTo;
+
+	//Changes every shot so repeated shots at the same point still replicate and reach replays
+	UPROPERTY()
+	uint8 ShotCount = 0;
 };
 
 UCLASS()
@@ -56,24 +62,28 @@ protected:
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
 	UAnimMontage* ReloadingMontage;
+
+	//Optional, the mesh only wakes up for the length of this animation when firing
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	UAnimationAsset* FireAnimation;
 	
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
 	int32 MaxMagCapacity;
 
+	//Mirrors SimState.Capacity for Blueprints
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
 	int32 Capacity;
 
 	UPROPERTY(ReplicatedUsing=OnRep_HitScanTrace)
 	FHitScanTrace HitScanTrace;
 
-	bool bCanFire;
+	//Fire cadence, magazine and reload rules, shared with the combat simulation
+	FWeaponSimState SimState;
 	
 	FTimerHandle TimerHandle_TimeBetweenShots;
 
-	float LastTimeFired;
+	FTimerHandle TimerHandle_MeshSleep;
 
-	float TimeBetweenShots;
-	
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
@@ -86,10 +96,18 @@ protected:
 	
 	virtual void Fire();
 
+	//Spends a round after a shot and stops firing when the magazine runs empty
+	void ConsumeShot();
+
 	void PlayFireEffect(FVector TraceEnd);
 
 	void PlayImpactEffect(FVector ImpactPoint);
 
+	//Plays a weapon animation with the mesh ticking only for its length, skipped on dedicated servers
+	void PlayWeaponAnimation(UAnimationAsset* Animation);
+
+	void SleepMesh();
+
 public:	
 
 	void StartFire();
@@ -97,4 +115,9 @@ public:
 	void StopFire();
 
 	void Reload();
+
+	FWeaponSimConfig GetSimConfig() const;
+
+	//Names the RPC bunch for mp.Net.Telemetry
+	virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack) override;
 };